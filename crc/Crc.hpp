@@ -6,6 +6,11 @@
 #include "tjg/Reflect.hpp"
 
 #include <ranges>
+#include <array>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
 
 namespace tjg::crc {
 
@@ -21,6 +26,34 @@ concept ContiguousByteRange = std::ranges::contiguous_range<R>
                            && std::ranges::sized_range<R>
                            && TrivialByte<std::ranges::range_value_t<R>>;
 
+/// Any range of bytes, including non-contiguous and single-pass ranges.
+template<class R>
+concept ByteRange = std::ranges::input_range<R>
+                 && TrivialByte<std::ranges::range_value_t<R>>;
+
+/// A range of contiguous byte ranges, e.g., std::vector<std::span<T>>.
+template<class R>
+concept SegmentedByteRange = std::ranges::input_range<R>
+                    && ContiguousByteRange<std::ranges::range_reference_t<R>>;
+
+namespace detail {
+
+template<class R>
+struct IsJoinView: std::false_type { };
+
+template<class V>
+struct IsJoinView<std::ranges::join_view<V>>: std::true_type { };
+
+template<class T>
+concept CrcLike = requires { typename T::value_type; }
+               && requires(T x, std::span<const std::byte> s) {
+                    x.reset();
+                    x.update(s);
+                    x.value();
+                  };
+
+} // detail
+
 template<std::size_t Bits_, uint_t<Bits_>::least Poly_, Endian Dir_,
          std::size_t Slices_ = DefaultSlices>
 requires ((Bits_ >= 3 && Bits_ <= 64)
@@ -38,15 +71,19 @@ protected:
   static constexpr auto CrcBits = 8 * sizeof(value_type);
   static constexpr unsigned Shift = CrcBits - Bits;
 
-private:
   static constexpr value_type FastPoly = (Dir == Endian::MsbFirst)
                                        ? (Poly << Shift)
                                        : (IntMath::Reflect(Poly) >> Shift);
 private:
-  const value_type _init;
-  const value_type _xor;
+  value_type _init;
+  value_type _xor;
   value_type _crc;
 
+protected:
+  /// The internal register.
+  constexpr value_type reg() const noexcept { return _crc; }
+  constexpr void reg(value_type crc) noexcept { _crc = crc; }
+
   static constexpr value_type Init(value_type init) noexcept {
     if constexpr (Dir == Endian::MsbFirst)
       return static_cast<value_type>(init << Shift);
@@ -54,16 +91,33 @@ private:
       return static_cast<value_type>(IntMath::Reflect(init) >> Shift);
   } // Init
 
+  /// Output value of register `crc`.
+  constexpr value_type Value(value_type crc) const noexcept {
+    if constexpr (Dir == Endian::MsbFirst)
+      return (crc >> Shift) ^ _xor;
+    else
+      return crc ^ _xor;
+  } // Value
+
+  /// Register that produces output value `v`; the inverse of Value().
+  constexpr value_type Register(value_type v) const noexcept {
+    v ^= _xor;
+    if constexpr (Dir == Endian::MsbFirst)
+      return static_cast<value_type>(v << Shift);
+    else
+      return v;
+  } // Register
+
 public:
   constexpr void reset() noexcept { _crc = _init; }
 
   [[nodiscard]]
-  constexpr value_type value() const noexcept {
-    if constexpr (Dir == Endian::MsbFirst)
-      return (_crc >> Shift) ^ _xor;
-    else
-      return _crc ^ _xor;
-  }
+  constexpr value_type value() const noexcept { return Value(_crc); }
+
+  /// Resumes from a checkpoint: `crc` is the value() of this CRC, with the
+  /// same parameters, after some prefix of the message.  Updating with the
+  /// rest of the message then gives the CRC of the whole.
+  constexpr void restore(value_type crc) noexcept { _crc = Register(crc); }
 
   constexpr explicit Crc(value_type init_, value_type xor_=0) noexcept
     : _init{Init(init_)} , _xor{xor_} , _crc{_init} { }
@@ -99,11 +153,105 @@ public:
   constexpr void update(const void* buf, std::size_t size) noexcept
     { update(std::span{static_cast<const std::byte*>(buf), size}); }
 
+  /// Update as if `n` zero bytes were processed, in O(log n) time.
+  constexpr void updateZeros(std::uint64_t n) noexcept
+    { _crc = detail::ShiftZeros<FastPoly, Dir, Bits>(_crc, n); }
+
+  /// Adjusts this CRC, which covers a message of `length` bytes, for a change
+  /// of the bytes at `offset` from `oldBytes` to `newBytes`.  Only the
+  /// changed bytes are read; the cost is O(size + log(length)).  Throws
+  /// std::invalid_argument if the spans differ in size and std::out_of_range
+  /// if they do not lie within the message.
+  constexpr void patch(std::uint64_t length, std::uint64_t offset,
+                       std::span<const std::byte> oldBytes,
+                       std::span<const std::byte> newBytes)
+  {
+    if (oldBytes.size() != newBytes.size())
+      throw std::invalid_argument{"Crc::patch: spans differ in size"};
+    auto size = oldBytes.size();
+    if (offset > length || size > length - offset)
+      throw std::out_of_range{"Crc::patch: bytes past end of message"};
+    // The CRC is affine, so only the difference matters, and zeros that
+    // precede it have no effect on a zero register.
+    auto delta = value_type{0};
+    alignas(8) std::array<std::byte, 256> buf;
+    for (std::size_t i = 0; i < size; i += buf.size()) {
+      auto n = std::min(buf.size(), size - i);
+      for (std::size_t j = 0; j != n; ++j)
+        buf[j] = oldBytes[i+j] ^ newBytes[i+j];
+      delta = detail::Compute<FastPoly, Dir, Slices>(delta,
+                                                   std::span{buf.data(), n});
+    }
+    _crc ^= detail::ShiftZeros<FastPoly, Dir, Bits>(delta,
+                                                    length - offset - size);
+  } // patch
+
   // Contiguous ranges.
   template<ContiguousByteRange R>
   constexpr void update(const R& r) noexcept
     { update(std::ranges::data(r), std::ranges::size(r)); }
 
+  // Ranges of contiguous ranges; each segment is processed in bulk.
+  template<SegmentedByteRange R>
+  constexpr void update(R&& r) {
+    for (auto&& segment: r)
+      update(segment);
+  }
+
+  // Non-contiguous ranges, e.g., std::deque or std::views::join.
+  // Joined contiguous segments are processed in place; otherwise, bytes are
+  // gathered into a small local buffer and processed in bulk.
+  template<ByteRange R>
+  requires (!ContiguousByteRange<R>)
+  constexpr void update(R&& r) {
+    using T = std::remove_cv_t<std::ranges::range_value_t<R>>;
+    if constexpr (detail::IsJoinView<std::remove_cvref_t<R>>::value
+               && requires { { r.base() } -> SegmentedByteRange; })
+    {
+      update(r.base());
+    } else {
+      alignas(8) std::array<T, 1024> buf;
+      auto first = std::ranges::begin(r);
+      auto last  = std::ranges::end(r);
+      if constexpr (std::ranges::sized_range<R>
+                 && std::ranges::random_access_range<R>)
+      {
+        auto left = static_cast<std::size_t>(std::ranges::size(r));
+        while (left != 0) {
+          auto n = std::min(left, buf.size());
+          first = std::ranges::copy_n(first, n, buf.data()).in;
+          update(std::as_bytes(std::span{buf.data(), n}));
+          left -= n;
+        }
+      } else {
+        while (first != last) {
+          auto n = std::size_t{0};
+          for ( ; n != buf.size() && first != last; ++n, ++first)
+            buf[n] = *first;
+          update(std::as_bytes(std::span{buf.data(), n}));
+        }
+      }
+    }
+  } // update
+
+  /// CRC of A followed by B, given crcA = CRC(A), crcB = CRC(B), and
+  /// the length of B in bytes.  Requires O(log lenB) polynomial products.
+  [[nodiscard]]
+  constexpr value_type combine(value_type crcA, value_type crcB,
+                               std::uint64_t lenB) const noexcept
+  {
+    auto a = static_cast<value_type>(Register(crcA) ^ _init);
+    return Value(Register(crcB)
+                 ^ detail::ShiftZeros<FastPoly, Dir, Bits>(a, lenB));
+  } // combine
+
+  /// Extends this CRC by a block of lenB bytes whose CRC, computed with the
+  /// same parameters, is crcB.  Equivalent to processing the block itself.
+  constexpr void append(value_type crcB, std::uint64_t lenB) noexcept {
+    auto a = static_cast<value_type>(_crc ^ _init);
+    _crc = Register(crcB) ^ detail::ShiftZeros<FastPoly, Dir, Bits>(a, lenB);
+  }
+
   constexpr operator value_type() const noexcept { return value(); }
 
   constexpr Crc& operator()(std::span<const std::byte> buf) noexcept
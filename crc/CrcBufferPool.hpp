@@ -0,0 +1,147 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+namespace tjg::crc {
+
+/// A thread-safe pool of page-aligned I/O buffers of one size, usable
+/// wherever a std::pmr::memory_resource is.  Requests that fit in a buffer
+/// are served from the pool, and returned buffers are kept for reuse, so
+/// that FileCrc and FileCksum, given the pool and a file name that is a
+/// path, string or C string, allocate nothing after the first call.
+/// Buffers are not zero-filled.  Larger requests go to the upstream
+/// resource.  With `hugePages`, buffers are 2 MiB aligned and advised to
+/// use transparent huge pages where the system supports it.
+class BufferPool: public std::pmr::memory_resource {
+public:
+  static constexpr std::size_t PageSize = 4096;
+  static constexpr std::size_t HugePageSize = std::size_t{2} << 20;
+
+  explicit BufferPool(std::size_t bufSize = std::size_t{1} << 20,
+                      bool hugePages = false,
+                      std::pmr::memory_resource* upstream
+                        = std::pmr::get_default_resource())
+    : _align{hugePages ? HugePageSize : PageSize}
+    , _bufSize{(std::max<std::size_t>(bufSize, 1) + _align - 1)
+               / _align * _align}
+    , _hugePages{hugePages}
+    , _upstream{upstream}
+    { }
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  ~BufferPool() override {
+    for (auto p: _free)
+      ::operator delete(p, _bufSize, std::align_val_t{_align});
+  }
+
+  std::size_t bufferSize() const noexcept { return _bufSize; }
+  std::size_t alignment()  const noexcept { return _align;   }
+
+  /// Number of buffers currently held for reuse.
+  std::size_t idle() const {
+    auto lock = std::lock_guard{_mutex};
+    return _free.size();
+  }
+
+private:
+  std::size_t _align;
+  std::size_t _bufSize;
+  bool _hugePages;
+  std::pmr::memory_resource* _upstream;
+  mutable std::mutex _mutex;
+  std::vector<void*> _free;
+
+  bool fits(std::size_t bytes, std::size_t align) const noexcept
+    { return bytes <= _bufSize && align <= _align; }
+
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    if (!fits(bytes, align))
+      return _upstream->allocate(bytes, align);
+    {
+      auto lock = std::lock_guard{_mutex};
+      if (!_free.empty()) {
+        auto p = _free.back();
+        _free.pop_back();
+        return p;
+      }
+    }
+    auto p = ::operator new(_bufSize, std::align_val_t{_align});
+#if defined(MADV_HUGEPAGE)
+    if (_hugePages)
+      ::madvise(p, _bufSize, MADV_HUGEPAGE);
+#endif
+    return p;
+  } // do_allocate
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+  {
+    if (!fits(bytes, align)) {
+      _upstream->deallocate(p, bytes, align);
+      return;
+    }
+    auto lock = std::lock_guard{_mutex};
+    _free.push_back(p);
+  } // do_deallocate
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+                   noexcept override
+    { return this == &other; }
+}; // BufferPool
+
+namespace detail {
+
+/// An uninitialized, page-aligned I/O buffer, from `mr` if given, or else
+/// from the global heap.
+class AlignedBuffer {
+  static constexpr auto Align = BufferPool::PageSize;
+  std::byte* _data = nullptr;
+  std::size_t _size = 0;
+  std::pmr::memory_resource* _mr = nullptr;
+public:
+  AlignedBuffer() noexcept = default;
+  explicit AlignedBuffer(std::size_t size,
+                         std::pmr::memory_resource* mr = nullptr)
+    : _size{size}, _mr{mr}
+  {
+    _data = static_cast<std::byte*>(
+              mr ? mr->allocate(size, Align)
+                 : ::operator new(size, std::align_val_t{Align}));
+  }
+  AlignedBuffer(AlignedBuffer&& other) noexcept
+    : _data{std::exchange(other._data, nullptr)}
+    , _size{std::exchange(other._size, 0)}
+    , _mr{other._mr}
+    { }
+  AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_mr, other._mr);
+    return *this;
+  }
+  ~AlignedBuffer() {
+    if (!_data)
+      return;
+    if (_mr)
+      _mr->deallocate(_data, _size, Align);
+    else
+      ::operator delete(_data, std::align_val_t{Align});
+  }
+  std::byte* data() const noexcept { return _data; }
+  std::size_t size() const noexcept { return _size; }
+}; // AlignedBuffer
+
+} // detail
+
+} // tjg::crc
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "crc/CrcKnown.hpp"
+
+#include <array>
+#include <span>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace tjg::crc {
+
+/// Wraps Known, collecting single bytes and small writes in a word-aligned
+/// buffer that is flushed through the slicing kernel, so byte-at-a-time
+/// producers get near-bulk throughput.  Results are identical to Known.
+template<class Traits_, std::size_t Slices_ = MaxSlices,
+         std::size_t BufSize_ = 256>
+requires (BufSize_ >= 8 && BufSize_ % 8 == 0)
+class BufferedCrc {
+public:
+  using Traits = Traits_;
+  using Crc = Known<Traits_, Slices_>;
+  using value_type = Crc::value_type;
+
+  static constexpr auto Slices  = Slices_;
+  static constexpr auto BufSize = BufSize_;
+  static constexpr auto Bits    = Traits::Bits;
+  static constexpr auto Name    = Traits::Name;
+  static constexpr auto Check   = Traits::Check;
+
+private:
+  Crc _crc;
+  std::size_t _size = 0;
+  alignas(8) std::array<std::byte, BufSize> _buf{};
+
+  constexpr std::span<const std::byte> pending() const noexcept
+    { return std::span{_buf.data(), _size}; }
+
+public:
+  /// Initial value and xor-output are specified by the Traits_ class.
+  constexpr explicit BufferedCrc(value_type init_ = Traits::Init) noexcept
+    : _crc{init_} { }
+
+  constexpr void reset() noexcept { _crc.reset(); _size = 0; }
+
+  /// Process all buffered bytes.
+  constexpr void flush() noexcept {
+    _crc.update(pending());
+    _size = 0;
+  }
+
+  constexpr void update(std::byte b) noexcept {
+    _buf[_size++] = b;
+    if (_size == BufSize)
+      flush();
+  }
+
+  constexpr void update(std::span<const std::byte> buf) noexcept {
+    if (buf.size() < BufSize - _size) {
+      std::ranges::copy(buf, _buf.data() + _size);
+      _size += buf.size();
+      return;
+    }
+    flush();
+    _crc.update(buf);
+  } // update
+
+  constexpr void update(const void* buf, std::size_t size) noexcept
+    { update(std::span{static_cast<const std::byte*>(buf), size}); }
+
+  template<ContiguousByteRange R>
+  constexpr void update(const R& r) noexcept
+    { update(std::ranges::data(r), std::ranges::size(r)); }
+
+  constexpr void updateZeros(std::uint64_t n) noexcept {
+    flush();
+    _crc.updateZeros(n);
+  }
+
+  /// Resumes from a checkpoint taken with value(), discarding any
+  /// buffered bytes.
+  constexpr void restore(value_type crc) noexcept {
+    _size = 0;
+    _crc.restore(crc);
+  }
+
+  /// The underlying CRC, after flushing the buffer.
+  constexpr const Crc& crc() noexcept { flush(); return _crc; }
+
+  [[nodiscard]]
+  constexpr value_type value() const noexcept {
+    auto crc = _crc;
+    crc.update(pending());
+    return crc.value();
+  }
+
+  constexpr operator value_type() const noexcept { return value(); }
+
+  constexpr BufferedCrc& operator()(std::byte b) noexcept
+    { update(b); return *this; }
+
+  constexpr BufferedCrc& operator()(std::span<const std::byte> buf) noexcept
+    { update(buf); return *this; }
+}; // BufferedCrc
+
+} // tjg::crc
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "crc/CrcRolling.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <span>
+#include <bit>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+namespace tjg::crc {
+
+/// Content-defined chunker.  A RollingCrc over the last Window_ bytes picks
+/// chunk boundaries that depend only on content, so an insertion or
+/// deletion disturbs only nearby chunks.  Each chunk's Known<Traits_> CRC
+/// is computed in bulk in the same pass.
+///
+/// A boundary follows the first byte, at least `minSize` bytes into the
+/// chunk, where the low bits of the rolling CRC are all zero.  The number
+/// of bits is chosen so that chunks average about `avgSize` bytes.
+/// Chunks are cut at `maxSize` bytes regardless of content.
+template<class Traits_, std::size_t Slices_ = MaxSlices,
+         std::size_t Window_ = 48>
+class CrcChunker {
+public:
+  using Traits = Traits_;
+  using Crc = Known<Traits_, Slices_>;
+  using value_type = Crc::value_type;
+
+  static constexpr auto Window = Window_;
+
+  struct Chunk {
+    std::uint64_t offset;   ///< Offset of the chunk in the stream.
+    std::uint64_t size;     ///< Chunk size in bytes.
+    value_type crc;         ///< Known<Traits_> CRC of the chunk.
+  }; // Chunk
+
+private:
+  RollingCrc<Traits_, Window_> _rolling;
+  Crc _crc;
+  std::uint64_t _min;
+  std::uint64_t _max;
+  value_type _mask;
+  std::uint64_t _offset = 0;    ///< Offset of the current chunk.
+  std::uint64_t _size = 0;      ///< Size of the current chunk so far.
+
+  static value_type Mask(std::size_t minSize, std::size_t avgSize) {
+    if (avgSize <= minSize)
+      return value_type{0};
+    auto bits = std::bit_width(avgSize - minSize) - 1;
+    if (bits > static_cast<int>(Traits::Bits))
+      throw std::invalid_argument{"CrcChunker: average size too large"};
+    return static_cast<value_type>((std::uint64_t{1} << bits) - 1);
+  } // Mask
+
+public:
+  CrcChunker(std::size_t minSize, std::size_t avgSize, std::size_t maxSize)
+    : _min{minSize}, _max{maxSize}, _mask{Mask(minSize, avgSize)}
+  {
+    if (minSize == 0 || minSize > avgSize || avgSize > maxSize)
+      throw std::invalid_argument{"CrcChunker: need 0 < min <= avg <= max"};
+  }
+
+  /// Start a new stream.
+  void reset() noexcept {
+    _rolling.reset();
+    _crc.reset();
+    _offset = 0;
+    _size = 0;
+  }
+
+  /// Process `buf`, calling `emit(const Chunk&)` for every completed chunk.
+  template<class F>
+  void update(std::span<const std::byte> buf, F&& emit) {
+    std::size_t start = 0;    // Start of the current chunk in buf.
+    std::size_t i = 0;
+    while (i != buf.size()) {
+      // Bytes that can neither end a chunk nor reach the window are skipped.
+      if (_size + Window < _min) {
+        auto skip = std::min<std::uint64_t>(buf.size() - i,
+                                            _min - Window - _size);
+        i     += skip;
+        _size += skip;
+        continue;
+      }
+      _rolling.update(buf[i++]);
+      ++_size;
+      if ((_size >= _min && (_rolling.value() & _mask) == 0)
+          || _size == _max)
+      {
+        _crc.update(buf.subspan(start, i - start));
+        emit(Chunk{_offset, _size, _crc.value()});
+        _offset += _size;
+        _size = 0;
+        _crc.reset();
+        _rolling.reset();
+        start = i;
+      }
+    }
+    _crc.update(buf.subspan(start));
+  } // update
+
+  /// End of stream: emit the final, possibly short, chunk.
+  template<class F>
+  void finish(F&& emit) {
+    if (_size != 0)
+      emit(Chunk{_offset, _size, _crc.value()});
+    reset();
+  }
+}; // CrcChunker
+
+} // tjg::crc
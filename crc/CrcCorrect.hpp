@@ -0,0 +1,202 @@
+#pragma once
+
+#include "crc/CrcKnown.hpp"
+
+#include <vector>
+#include <span>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+namespace tjg::crc {
+
+/// Corrects single-bit, and optionally double-bit, errors in frames of up
+/// to `maxPayload` payload bytes followed by their Known<Traits_>::Trailer().
+///
+/// The syndrome of an error depends only on its distance, in bits, from the
+/// end of the frame, so one syndrome -> distance hash table serves every
+/// frame length up to the maximum.  A single-bit error is located with one
+/// lookup; a double-bit error with one lookup per bit of the frame.
+/// Syndromes that several positions share are marked ambiguous, and such
+/// errors are reported as uncorrectable rather than mis-corrected.
+template<class Traits_, std::size_t Slices_ = MaxSlices>
+class CrcCorrector {
+public:
+  using Traits = Traits_;
+  using Crc = Known<Traits_, Slices_>;
+  using value_type = Crc::value_type;
+
+  static constexpr auto Bits = Traits::Bits;
+  static constexpr auto Dir  = Crc::Dir;
+  static constexpr auto TrailerSize = Crc::TrailerSize;
+
+  /// Location of a bit in a frame; bit 0 is the least significant.
+  struct BitPos {
+    std::size_t byte;
+    unsigned bit;
+  }; // BitPos
+
+private:
+  /// Exposes the register-level parameters of Known.
+  struct Access: Known<Traits_, 1> {
+    using Base = Known<Traits_, 1>;
+    using Base::FastPoly;
+    using Base::Shift;
+    using Base::Output;
+  }; // Access
+
+  static constexpr auto Empty     = std::numeric_limits<std::uint32_t>::max();
+  static constexpr auto Ambiguous = Empty - 1;
+
+  struct Slot {
+    value_type syndrome;
+    std::uint32_t dist = Empty;
+  }; // Slot
+
+  std::size_t _maxPayload;
+  std::vector<value_type> _syndrome;  ///< Indexed by distance from the end.
+  std::vector<Slot> _slots;
+  unsigned _hashShift;
+
+  std::size_t slot(value_type s) const noexcept {
+    auto h = static_cast<std::uint64_t>(s) * 0x9e37'79b9'7f4a'7c15u;
+    return static_cast<std::size_t>(h >> _hashShift);
+  }
+
+  /// Distance of the error with syndrome `s`, Empty, or Ambiguous.
+  std::uint32_t find(value_type s) const noexcept {
+    for (auto i = slot(s); ; i = (i + 1) & (_slots.size() - 1)) {
+      if (_slots[i].dist == Empty || _slots[i].syndrome == s)
+        return _slots[i].dist;
+    }
+  } // find
+
+  void insert(value_type s, std::uint32_t dist) noexcept {
+    for (auto i = slot(s); ; i = (i + 1) & (_slots.size() - 1)) {
+      if (_slots[i].dist == Empty) {
+        _slots[i] = Slot{s, dist};
+        return;
+      }
+      if (_slots[i].syndrome == s) {
+        _slots[i].dist = Ambiguous;
+        return;
+      }
+    }
+  } // insert
+
+  /// Number of bits covered by the CRC in a frame of `size` bytes.
+  static constexpr std::uint64_t FrameBits(std::size_t size) noexcept
+    { return 8 * std::uint64_t{size - TrailerSize} + Bits; }
+
+  /// Location of the bit `dist` bits from the end of a `size`-byte frame,
+  /// in the order that Known::Syndrome() processes them.
+  static constexpr BitPos Position(std::uint64_t dist, std::size_t size)
+                                   noexcept
+  {
+    constexpr auto Partial = Bits % 8;
+    auto t = FrameBits(size) - 1 - dist;
+    if constexpr (Dir == Endian::LsbFirst) {
+      return BitPos{static_cast<std::size_t>(t / 8),
+                    static_cast<unsigned>(t % 8)};
+    } else {
+      // The partial trailer byte contributes its low-order bits only.
+      auto p = std::uint64_t{size - TrailerSize};
+      if (Partial != 0 && t >= 8 * p) {
+        auto u = t - 8 * p;
+        if (u < Partial)
+          return BitPos{static_cast<std::size_t>(p),
+                        static_cast<unsigned>(Partial - 1 - u)};
+        t = 8 * (p + 1) + (u - Partial);
+      }
+      return BitPos{static_cast<std::size_t>(t / 8),
+                    static_cast<unsigned>(7 - t % 8)};
+    }
+  } // Position
+
+  static void Flip(std::span<std::byte> frame, BitPos pos) noexcept
+    { frame[pos.byte] ^= std::byte{1} << pos.bit; }
+
+public:
+  /// Builds the syndrome table for payloads of up to `maxPayload` bytes.
+  explicit CrcCorrector(std::size_t maxPayload)
+    : _maxPayload{maxPayload}
+  {
+    constexpr auto Poly = Access::FastPoly;
+    if (maxPayload > (Ambiguous - Bits) / 8)
+      throw std::invalid_argument{"CrcCorrector: payload too large"};
+    auto n = static_cast<std::size_t>(8 * maxPayload + Bits);
+    // The register difference caused by an error d bits from the end is
+    // x^d times that of the last bit.  Distances d and d+8 are one zero byte
+    // apart, so eight independent chains of table lookups fill the table.
+    _syndrome.resize(n);
+    auto r = Access::FastPoly;
+    for (std::size_t d = 0; d != std::min<std::size_t>(n, 8); ++d) {
+      _syndrome[d] = r;
+      r = detail::Compute<Poly, Dir>(r, false);
+    }
+    for (std::size_t d = 8; d < n; ++d)
+      _syndrome[d] = detail::Compute<Poly, Dir, 1>(_syndrome[d-8],
+                                                   std::byte{0});
+    for (auto& s: _syndrome) {
+      if constexpr (Dir == Endian::MsbFirst)
+        s = static_cast<value_type>(s >> Access::Shift);
+      s = Access::Output(s);
+    }
+    auto capacity = std::bit_ceil(2 * n);
+    _slots.resize(capacity);
+    _hashShift = 64 - std::countr_zero(capacity);
+    for (std::size_t d = 0; d != n; ++d)
+      insert(_syndrome[d], static_cast<std::uint32_t>(d));
+  } // ctor
+
+  std::size_t maxPayload() const noexcept { return _maxPayload; }
+
+  /// Checks `frame`, a payload followed by its trailer, and corrects a
+  /// single-bit error in place, or if `doubleBit` is set, a double-bit
+  /// error.  Returns the number of bits corrected (0 for an intact frame),
+  /// or -1, leaving the frame unchanged, if the error cannot be corrected.
+  int correct(std::span<std::byte> frame, bool doubleBit = false) const {
+    if (frame.size() < TrailerSize
+        || frame.size() - TrailerSize > _maxPayload)
+    {
+      throw std::out_of_range{"CrcCorrector: bad frame size"};
+    }
+    auto s = Crc::Syndrome(frame);
+    if (s == 0)
+      return 0;
+    auto bits = FrameBits(frame.size());
+    auto d = find(s);
+    if (d == Ambiguous)
+      return -1;
+    if (d != Empty && d < bits) {
+      Flip(frame, Position(d, frame.size()));
+      return 1;
+    }
+    if (!doubleBit)
+      return -1;
+    // Pair each position with the one that would complete the syndrome;
+    // the correction must be unique.
+    auto found = std::uint64_t{0};
+    auto first = Empty, second = Empty;
+    for (std::uint32_t d1 = 0; d1 != bits; ++d1) {
+      auto d2 = find(static_cast<value_type>(s ^ _syndrome[d1]));
+      if (d2 == Ambiguous)
+        return -1;
+      if (d2 == Empty || d2 <= d1 || d2 >= bits)
+        continue;
+      if (++found > 1)
+        return -1;
+      first  = d1;
+      second = d2;
+    }
+    if (found == 0)
+      return -1;
+    Flip(frame, Position(first, frame.size()));
+    Flip(frame, Position(second, frame.size()));
+    return 2;
+  } // correct
+}; // CrcCorrector
+
+} // tjg::crc
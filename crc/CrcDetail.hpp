@@ -1,6 +1,10 @@
 #pragma once
 
+#include "tjg/Gf2Poly.hpp"
+#include "tjg/Reflect.hpp"
+
 #include <array>
+#include <algorithm>
 #include <span>
 #include <concepts>
 #include <type_traits>
@@ -300,7 +304,7 @@ constexpr auto Compute(std::unsigned_integral auto crc,
   auto num = static_cast<std::size_t>(
                                   reinterpret_cast<std::uintptr_t>(p) % Slices);
   if (num != 0) {
-    num = Slices - num;
+    num = std::min(Slices - num, sz);
     crc = DoSlice<Poly, Dir>(crc, p, num);
     p  += num;
     sz -= num;
@@ -319,4 +323,113 @@ constexpr auto Compute(std::unsigned_integral auto crc,
   return crc;
 } // Compute
 
+// Polynomials modulo Poly, in the same representation as the CRC register:
+// for MsbFirst, x^0 is bit (8*sizeof(Uint) - Bits) and x^(Bits-1) is the
+// MSB; for LsbFirst, x^(Bits-1) is bit 0 and x^0 is bit (Bits - 1).
+// Poly must already be shifted (MsbFirst) or reflected (LsbFirst).
+
+// The polynomial "1" (x^0).
+template<std::unsigned_integral auto Poly, Endian Dir, std::size_t Bits>
+constexpr auto One() noexcept -> decltype(Poly) {
+  using Uint = decltype(Poly);
+  if constexpr (Dir == Endian::MsbFirst)
+    return Uint{1} << (8 * sizeof(Uint) - Bits);
+  else
+    return Uint{1} << (Bits - 1);
+} // One
+
+// Converts between the register representation and the natural one, in
+// which bit i is the coefficient of x^i.  Each conversion is its own
+// inverse for LsbFirst.
+template<Endian Dir, std::size_t Bits>
+constexpr auto ToNatural(std::unsigned_integral auto r) noexcept
+  -> std::uint64_t
+{
+  static_assert(Bits <= 64);
+  auto v = static_cast<std::uint64_t>(r);
+  if constexpr (Dir == Endian::MsbFirst)
+    return v >> (8 * sizeof(r) - Bits);
+  else
+    return IntMath::Reflect(v) >> (64 - Bits);
+} // ToNatural
+
+template<std::unsigned_integral Uint, Endian Dir, std::size_t Bits>
+constexpr auto FromNatural(std::uint64_t v) noexcept -> Uint {
+  if constexpr (Dir == Endian::MsbFirst)
+    return static_cast<Uint>(v << (8 * sizeof(Uint) - Bits));
+  else
+    return static_cast<Uint>(IntMath::Reflect(v) >> (64 - Bits));
+} // FromNatural
+
+// Product a * b modulo Poly.  At run time, if the target has PCLMULQDQ,
+// this is a carry-less multiply with Barrett reduction; otherwise it is
+// Bits steps of shift-and-add.
+template<std::unsigned_integral auto Poly, Endian Dir, std::size_t Bits>
+constexpr auto MulMod(decltype(Poly) a, decltype(Poly) b) noexcept
+  -> decltype(Poly)
+{
+  using Uint = decltype(Poly);
+#if defined(__PCLMUL__)
+  if constexpr (Bits <= 64) {
+    if !consteval {
+      static constexpr auto Modulus =
+          IntMath::Gf2Modulus{ToNatural<Dir, Bits>(Poly), Bits};
+      return FromNatural<Uint, Dir, Bits>(
+               Modulus.mulMod(ToNatural<Dir, Bits>(a),
+                              ToNatural<Dir, Bits>(b)));
+    }
+  }
+#endif
+  static constexpr auto Shift = 8 * sizeof(Uint) - Bits;
+  auto p = Uint{0};
+  for (std::size_t i = 0; i != Bits; ++i) {
+    auto bit = (Dir == Endian::MsbFirst) ? (a >> (Shift + i))
+                                         : (a >> (Bits - 1 - i));
+    p ^= static_cast<Uint>(-(bit & 1)) & b;
+    b = Update<Poly, Dir>(b, false);    // b *= x
+  }
+  return p;
+} // MulMod
+
+// Table of x^(8 * 2^k) modulo Poly, for k in [0, 64).
+template<std::unsigned_integral auto Poly, Endian Dir, std::size_t Bits>
+class ZerosTable : public std::array<decltype(Poly), 64> {
+private:
+  using Uint  = decltype(Poly);
+  using Table = std::array<Uint, 64>;
+
+  static consteval Table Generate() noexcept {
+    auto table = Table{};
+    auto x8 = One<Poly, Dir, Bits>();
+    for (int i = 0; i != 8; ++i)
+      x8 = Update<Poly, Dir>(x8, false);
+    table[0] = x8;
+    for (std::size_t k = 1; k != table.size(); ++k)
+      table[k] = MulMod<Poly, Dir, Bits>(table[k-1], table[k-1]);
+    return table;
+  } // Generate
+
+  constexpr ZerosTable() : Table{Generate()} { }
+
+public:
+  static constexpr const ZerosTable& Get() noexcept {
+    static constexpr auto TheTable = ZerosTable{};
+    return TheTable;
+  }
+}; // ZerosTable
+
+// Advance the register as if n zero bytes were processed: crc * x^(8n).
+// O(log n) multiplications.
+template<std::unsigned_integral auto Poly, Endian Dir, std::size_t Bits>
+constexpr auto ShiftZeros(decltype(Poly) crc, std::uint64_t n) noexcept
+  -> decltype(Poly)
+{
+  static constexpr const auto& Table = ZerosTable<Poly, Dir, Bits>::Get();
+  for (int k = 0; n != 0; ++k, n >>= 1) {
+    if (n & 1)
+      crc = MulMod<Poly, Dir, Bits>(crc, Table[k]);
+  }
+  return crc;
+} // ShiftZeros
+
 } // tjg::crc::detail
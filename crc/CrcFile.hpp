@@ -1,53 +1,944 @@
+#pragma once
+
 #include "crc/CrcKnown.hpp"
+#include "crc/CrcParallel.hpp"
+#include "crc/CrcBufferPool.hpp"
 
 #include <vector>
 #include <fstream>
+#include <random>
 #include <filesystem>
+#include <algorithm>
+#include <memory_resource>
+#include <system_error>
+#include <stdexcept>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <concepts>
+#include <utility>
+#include <span>
+#include <array>
+#include <iosfwd>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TJG_CRC_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define TJG_CRC_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <atomic>
+#endif
 
 namespace tjg::crc {
 
 namespace detail {
 
+constexpr std::size_t FileBufSize = std::size_t{1} << 20;
+
+/// Writes `x` as 8 little-endian bytes.
+inline void PutLe64(std::ostream& out, std::uint64_t x) {
+  char b[8];
+  for (auto& c: b) {
+    c = static_cast<char>(x & 0xff);
+    x >>= 8;
+  }
+  out.write(b, sizeof(b));
+} // PutLe64
+
+/// Reads 8 little-endian bytes into `x`; false at end of file.
+inline bool GetLe64(std::istream& in, std::uint64_t& x) {
+  unsigned char b[8];
+  if (!in.read(reinterpret_cast<char*>(b), sizeof(b)))
+    return false;
+  x = 0;
+  for (auto i = sizeof(b); i-- != 0; )
+    x = (x << 8) | b[i];
+  return true;
+} // GetLe64
+
+/// Replaces `name` with what `write` puts to the std::ostream it is given.
+/// The data goes to a new file with a random name in the same directory,
+/// which is then renamed over `name`, so that concurrent writers never
+/// share a temporary and readers see either the old file or a whole new
+/// one.  The temporary is removed if anything fails.
+void AtomicWrite(const std::filesystem::path& name, auto write) {
+  auto rd = std::random_device{};
+  auto bits = (std::uint64_t{rd()} << 32) | rd();
+  auto tmp = name;
+  tmp += ".tmp";
+  for (int i = 0; i != 16; ++i, bits >>= 4)
+    tmp += "0123456789abcdef"[bits & 0xf];
+  auto out = std::ofstream{};
+  out.exceptions(std::ios::failbit | std::ios::badbit);
+  out.open(tmp, std::ios::out | std::ios::binary | std::ios::noreplace);
+  try {
+    write(static_cast<std::ostream&>(out));
+    out.close();
+    std::filesystem::rename(tmp, name);
+  } catch (...) {
+    auto ec = std::error_code{};
+    std::filesystem::remove(tmp, ec);
+    throw;
+  }
+} // AtomicWrite
+
+/// Parameters of Known<Traits>, for validating persisted CRCs.
+template<class Traits>
+constexpr std::array<std::uint64_t, 5> AlgorithmParams() noexcept {
+  return {Traits::Bits, std::uint64_t{Traits::Poly},
+          std::uint64_t{Traits::Init}, std::uint64_t{Traits::XorOut},
+          std::uint64_t{Traits::ReflectIn} | (Traits::ReflectOut << 1)};
+} // AlgorithmParams
+
+/// Appends the length of the data, as cksum(1) does.
+void AppendLength(CrcLike auto& crc, std::uint64_t size) {
+  while (size != 0) {
+    crc.update(static_cast<std::byte>(size & 0xff));
+    size >>= 8;
+  }
+} // AppendLength
+
+} // detail
+
+#if defined(TJG_CRC_POSIX)
+
+namespace detail {
+
+[[noreturn]] inline void ThrowErrno(const char* what) {
+  throw std::system_error{errno, std::generic_category(), what};
+}
+
+/// Owns a POSIX file descriptor.
+class FileDesc {
+  int _fd = -1;
+public:
+  FileDesc() noexcept = default;
+  explicit FileDesc(int fd) noexcept : _fd{fd} { }
+  FileDesc(FileDesc&& other) noexcept : _fd{std::exchange(other._fd, -1)} { }
+  FileDesc& operator=(FileDesc&& other) noexcept {
+    std::swap(_fd, other._fd);
+    return *this;
+  }
+  ~FileDesc() {
+    if (_fd >= 0)
+      ::close(_fd);
+  }
+  int get() const noexcept { return _fd; }
+  explicit operator bool() const noexcept { return _fd >= 0; }
+}; // FileDesc
+
+inline FileDesc OpenRead(const char* name, int flags = 0) {
+  auto fd = ::open(name, O_RDONLY | O_CLOEXEC | flags);
+  if (fd < 0)
+    ThrowErrno("open");
+  return FileDesc{fd};
+} // OpenRead
+
+inline FileDesc OpenRead(const std::filesystem::path& name, int flags = 0)
+{ return OpenRead(name.c_str(), flags); }
+
+inline std::uint64_t FileSize(int fd) {
+  struct ::stat st;
+  if (::fstat(fd, &st) != 0)
+    ThrowErrno("fstat");
+  return static_cast<std::uint64_t>(st.st_size);
+} // FileSize
+
+/// The identity and version of a file, as far as stat(2) can tell.
+struct FileStat {
+  std::uint64_t dev = 0;
+  std::uint64_t ino = 0;
+  std::uint64_t size = 0;
+  std::int64_t mtimeNs = 0;
+  std::int64_t ctimeNs = 0;
+  bool operator==(const FileStat&) const = default;
+}; // FileStat
+
+inline FileStat Stat(const struct ::stat& st) noexcept {
+#if defined(__APPLE__)
+  const auto& m = st.st_mtimespec;
+  const auto& c = st.st_ctimespec;
+#else
+  const auto& m = st.st_mtim;
+  const auto& c = st.st_ctim;
+#endif
+  return FileStat{
+    static_cast<std::uint64_t>(st.st_dev),
+    static_cast<std::uint64_t>(st.st_ino),
+    static_cast<std::uint64_t>(st.st_size),
+    std::int64_t{m.tv_sec} * 1'000'000'000 + m.tv_nsec,
+    std::int64_t{c.tv_sec} * 1'000'000'000 + c.tv_nsec
+  };
+} // Stat
+
+inline FileStat Stat(int fd) {
+  struct ::stat st;
+  if (::fstat(fd, &st) != 0)
+    ThrowErrno("fstat");
+  return Stat(st);
+} // Stat
+
+inline FileStat Stat(const std::filesystem::path& name) {
+  struct ::stat st;
+  if (::stat(name.c_str(), &st) != 0)
+    ThrowErrno("stat");
+  return Stat(st);
+} // Stat
+
+/// A read-only mapping of part of a file.
+class Mapping {
+  void* _addr = MAP_FAILED;
+  std::size_t _size = 0;
+public:
+  Mapping(int fd, std::uint64_t offset, std::size_t size) : _size{size} {
+    _addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd,
+                   static_cast<::off_t>(offset));
+    if (_addr == MAP_FAILED)
+      ThrowErrno("mmap");
+  }
+  Mapping(const Mapping&) = delete;
+  Mapping& operator=(const Mapping&) = delete;
+  ~Mapping() { ::munmap(_addr, _size); }
+
+  /// Hints are advisory; failures are ignored.
+  void advise(int advice) const noexcept { ::madvise(_addr, _size, advice); }
+
+  std::span<const std::byte> bytes() const noexcept
+    { return {static_cast<const std::byte*>(_addr), _size}; }
+}; // Mapping
+
+} // detail
+
+/// Like FileCrc, but maps the file into memory, `window` bytes at a time,
+/// and runs the CRC directly on the mapped pages, avoiding the copy into a
+/// user buffer.  The next window is requested from the kernel while the
+/// current one is processed.  A file that is truncated while being read
+/// raises SIGBUS.
+auto MappedFileCrc(const auto& name, detail::CrcLike auto crc,
+                   std::size_t window = std::size_t{1} << 30)
+{
+  auto fd = detail::OpenRead(std::filesystem::path{name});
+  auto size = detail::FileSize(fd.get());
+#if defined(POSIX_FADV_SEQUENTIAL)
+  ::posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  // Windows must start on page boundaries.
+  auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  window = std::max(page, window / page * page);
+  for (std::uint64_t offset = 0; offset < size; offset += window) {
+    auto len = static_cast<std::size_t>(std::min<std::uint64_t>(window,
+                                                        size - offset));
+    auto map = detail::Mapping{fd.get(), offset, len};
+    map.advise(MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+    map.advise(MADV_HUGEPAGE);
+#endif
+#if defined(POSIX_FADV_WILLNEED)
+    if (offset + len < size) {
+      ::posix_fadvise(fd.get(), static_cast<::off_t>(offset + len),
+                      static_cast<::off_t>(window), POSIX_FADV_WILLNEED);
+    }
+#endif
+    crc.update(map.bytes());
+  }
+  return crc;
+} // MappedFileCrc
+
+inline auto MappedFileCrc(const auto& name)
+{ return MappedFileCrc(name, Known<Crc32IsoHdlc, 8>{}); }
+
+#if defined(TJG_CRC_URING)
+
+namespace detail {
+
+/// A minimal io_uring driven through the raw system calls, for reads only.
+class Uring {
+  FileDesc _ring;
+  io_uring_params _params{};
+  void* _sq = MAP_FAILED;
+  void* _cq = MAP_FAILED;
+  std::size_t _sqSize = 0;
+  std::size_t _cqSize = 0;
+  io_uring_sqe* _sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+  unsigned _toSubmit = 0;
+  unsigned _pending = 0;  ///< Reads queued but not yet reaped.
+
+  template<class T>
+  T* at(void* ring, unsigned offset) const noexcept
+    { return reinterpret_cast<T*>(static_cast<char*>(ring) + offset); }
+
+  void unmap() noexcept {
+    if (_sqes != MAP_FAILED)
+      ::munmap(_sqes, _params.sq_entries * sizeof(io_uring_sqe));
+    if (_cq != MAP_FAILED && _cq != _sq)
+      ::munmap(_cq, _cqSize);
+    if (_sq != MAP_FAILED)
+      ::munmap(_sq, _sqSize);
+  } // unmap
+
+  static void* Map(int fd, std::size_t size, std::uint64_t offset) {
+    auto p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd,
+                    static_cast<::off_t>(offset));
+    if (p == MAP_FAILED)
+      ThrowErrno("mmap io_uring");
+    return p;
+  }
+
+public:
+  /// Sets up a ring of at least `entries` entries.  Throws std::system_error
+  /// if the kernel does not provide io_uring.
+  explicit Uring(unsigned entries) {
+    auto fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries,
+                                         &_params));
+    if (fd < 0)
+      ThrowErrno("io_uring_setup");
+    _ring = FileDesc{fd};
+    _sqSize = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+    _cqSize = _params.cq_off.cqes
+            + _params.cq_entries * sizeof(io_uring_cqe);
+    if (_params.features & IORING_FEAT_SINGLE_MMAP)
+      _sqSize = _cqSize = std::max(_sqSize, _cqSize);
+    try {
+      _sq = Map(fd, _sqSize, IORING_OFF_SQ_RING);
+      _cq = (_params.features & IORING_FEAT_SINGLE_MMAP)
+          ? _sq : Map(fd, _cqSize, IORING_OFF_CQ_RING);
+      _sqes = static_cast<io_uring_sqe*>(
+                Map(fd, _params.sq_entries * sizeof(io_uring_sqe),
+                    IORING_OFF_SQES));
+    } catch (...) {
+      unmap();
+      throw;
+    }
+  } // ctor
+
+  Uring(const Uring&) = delete;
+  Uring& operator=(const Uring&) = delete;
+
+  /// Reaps any outstanding reads first: closing the ring does not wait for
+  /// them, and the kernel could otherwise write into freed buffers.
+  ~Uring() {
+    drain();
+    unmap();
+  }
+
+  /// Queues a read of `len` bytes at `offset` of `fd` into `buf`.
+  void read(int fd, void* buf, unsigned len, std::uint64_t offset,
+            std::uint64_t userData) noexcept
+  {
+    auto tail = std::atomic_ref{*at<unsigned>(_sq, _params.sq_off.tail)};
+    auto t = tail.load(std::memory_order_relaxed);
+    auto index = t & *at<unsigned>(_sq, _params.sq_off.ring_mask);
+    auto& sqe = _sqes[index];
+    sqe = io_uring_sqe{};
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<std::uintptr_t>(buf);
+    sqe.len = len;
+    sqe.off = offset;
+    sqe.user_data = userData;
+    at<unsigned>(_sq, _params.sq_off.array)[index] = index;
+    tail.store(t + 1, std::memory_order_release);
+    ++_toSubmit;
+    ++_pending;
+  } // read
+
+  /// Submits queued reads and waits for a completion, returning its
+  /// user data and result (a byte count or a negated errno).
+  std::pair<std::uint64_t, int> wait() {
+    auto head = std::atomic_ref{*at<unsigned>(_cq, _params.cq_off.head)};
+    auto tail = std::atomic_ref{*at<unsigned>(_cq, _params.cq_off.tail)};
+    auto h = head.load(std::memory_order_relaxed);
+    while (_toSubmit != 0 || tail.load(std::memory_order_acquire) == h) {
+      auto n = ::syscall(__NR_io_uring_enter, _ring.get(), _toSubmit, 1u,
+                         IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        ThrowErrno("io_uring_enter");
+      }
+      _toSubmit -= static_cast<unsigned>(n);
+    }
+    auto mask = *at<unsigned>(_cq, _params.cq_off.ring_mask);
+    auto cqe = at<io_uring_cqe>(_cq, _params.cq_off.cqes)[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    --_pending;
+    return {cqe.user_data, cqe.res};
+  } // wait
+
+  /// Submits any queued reads and waits for every outstanding one,
+  /// discarding the results.
+  void drain() noexcept {
+    try {
+      while (_pending != 0)
+        wait();
+    } catch (const std::system_error&) {
+      // io_uring_enter failed; nothing more can be done.
+    }
+  } // drain
+}; // Uring
+
+} // detail
+
+/// Like FileCrc, but keeps `depth` reads of `bufSize` bytes in flight with
+/// io_uring, computing the CRC over completed buffers in file order while
+/// later reads are outstanding, so that I/O and computation overlap.  With
+/// `direct`, the file is opened with O_DIRECT when the filesystem allows,
+/// bypassing the page cache; `bufSize` should then be a multiple of the
+/// device block size.  Falls back to synchronous reads where the kernel
+/// does not provide io_uring.
+auto UringFileCrc(const auto& name, detail::CrcLike auto crc,
+                  unsigned depth = 4, std::size_t bufSize = 1<<20,
+                  bool direct = false)
+{
+  if (depth == 0 || bufSize == 0 || bufSize > (1u << 30))
+    throw std::invalid_argument{"UringFileCrc: bad depth or buffer size"};
+  auto path = std::filesystem::path{name};
+  auto fd = detail::FileDesc{};
+  if (direct) {
+    auto d = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+    if (d >= 0)
+      fd = detail::FileDesc{d};
+    else if (errno != EINVAL)
+      detail::ThrowErrno("open");
+  }
+  if (!fd)
+    fd = detail::OpenRead(path);
+  const auto size = detail::FileSize(fd.get());
+  auto bufs = std::vector<detail::AlignedBuffer>{};
+  for (unsigned i = 0; i != depth; ++i)
+    bufs.emplace_back(bufSize);
+  const auto len = static_cast<unsigned>(bufSize);
+
+  // Completes a short read synchronously.  Whole buffers are requested,
+  // keeping O_DIRECT lengths aligned.
+  auto finish = [&](std::byte* buf, std::size_t got, std::size_t want,
+                    std::uint64_t offset)
+  {
+    while (got < want) {
+      auto n = ::pread(fd.get(), buf + got, bufSize - got,
+                       static_cast<::off_t>(offset + got));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0)
+        detail::ThrowErrno("pread");
+      if (n == 0)
+        throw std::runtime_error{"UringFileCrc: file truncated"};
+      got += static_cast<std::size_t>(n);
+    }
+  }; // finish
+
+  // Declared after `fd` and `bufs`, so that on an error the ring is
+  // destroyed, and its outstanding reads reaped, before they are.
+  auto ring = std::unique_ptr<detail::Uring>{};
+  try {
+    ring = std::make_unique<detail::Uring>(depth);
+  } catch (const std::system_error& x) {
+    if (x.code() != std::errc::function_not_supported
+        && x.code() != std::errc::operation_not_permitted)
+    {
+      throw;
+    }
+  }
+  if (!ring) {
+    for (std::uint64_t offset = 0; offset < size; offset += bufSize) {
+      auto want = static_cast<std::size_t>(
+                    std::min<std::uint64_t>(bufSize, size - offset));
+      finish(bufs[0].data(), 0, want, offset);
+      crc.update(std::span{bufs[0].data(), want});
+    }
+    return crc;
+  }
+
+  // Block i goes to buffer i % depth; results are kept until block i is
+  // next in order.
+  const auto blocks = (size + bufSize - 1) / bufSize;
+  auto result = std::vector<int>(depth);
+  auto done = std::vector<bool>(depth);
+  auto issued = std::uint64_t{0};
+  for ( ; issued != std::min<std::uint64_t>(blocks, depth); ++issued)
+    ring->read(fd.get(), bufs[issued].data(), len, issued * bufSize, issued);
+  for (std::uint64_t next = 0; next != blocks; ++next) {
+    auto slot = static_cast<std::size_t>(next % depth);
+    while (!done[slot]) {
+      auto [block, res] = ring->wait();
+      auto s = static_cast<std::size_t>(block % depth);
+      result[s] = res;
+      done[s] = true;
+    }
+    done[slot] = false;
+    if (result[slot] < 0) {
+      errno = -result[slot];
+      detail::ThrowErrno("io_uring read");
+    }
+    auto offset = next * bufSize;
+    auto want = static_cast<std::size_t>(
+                  std::min<std::uint64_t>(bufSize, size - offset));
+    auto got = std::min(static_cast<std::size_t>(result[slot]), want);
+    finish(bufs[slot].data(), got, want, offset);
+    crc.update(std::span{bufs[slot].data(), want});
+    if (issued != blocks) {
+      ring->read(fd.get(), bufs[slot].data(), len, issued * bufSize, issued);
+      ++issued;
+    }
+  }
+  return crc;
+} // UringFileCrc
+
+inline auto UringFileCrc(const auto& name)
+{ return UringFileCrc(name, Known<Crc32IsoHdlc, 8>{}); }
+
+#endif // TJG_CRC_URING
+
+/// A byte range of a file; by default, the whole file.
+struct FileRange {
+  static constexpr auto ToEnd = std::numeric_limits<std::uint64_t>::max();
+  std::uint64_t offset = 0;
+  std::uint64_t length = ToEnd;
+}; // FileRange
+
+namespace detail {
+
+/// Smallest part of a file worth a thread of its own.  Unlike
+/// MinParallelChunk this is bound by I/O, not thread start-up: each worker
+/// allocates its own buffer and opens a sequential stream at a new offset,
+/// so a part should span many reads for the kernel's read-ahead to pay off
+/// before the next seek.  A 256 KiB part would be a quarter of one read.
+constexpr std::uint64_t MinParallelFileChunk = 16 * FileBufSize; // 16 MiB
+
+/// Updates `crc` with `length` bytes of `fd` at `offset`, read with pread
+/// through `buf`.
+void PreadUpdate(CrcLike auto& crc, int fd, std::uint64_t offset,
+                 std::uint64_t length, std::span<std::byte> buf)
+{
+  while (length != 0) {
+    auto want = static_cast<std::size_t>(
+                  std::min<std::uint64_t>(buf.size(), length));
+    auto n = ::pread(fd, buf.data(), want, static_cast<::off_t>(offset));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      ThrowErrno("pread");
+    if (n == 0)
+      throw std::runtime_error{"pread: file truncated"};
+    auto got = static_cast<std::size_t>(n);
+    crc.update(std::span{buf.data(), got});
+    offset += got;
+    length -= got;
+  }
+} // PreadUpdate
+
 template<class T>
-concept CrcLike = requires { typename T::value_type; }
-               && requires(T x, std::span<const std::byte> s) {
-                    x.reset();
-                    x.update(s);
-                    x.value();
-                  };
+concept ZeroExtendable = CrcLike<T>
+          && requires(T x, std::uint64_t n) { x.updateZeros(n); };
+
+/// Like PreadUpdate, but reads only the data extents of a sparse file and
+/// advances the CRC across holes arithmetically, in O(log n) time per hole.
+/// Where the filesystem cannot report holes, everything is read.
+void SparseUpdate(ZeroExtendable auto& crc, int fd, std::uint64_t offset,
+                  std::uint64_t length, std::span<std::byte> buf)
+{
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+  const auto end = offset + length;
+  while (offset != end) {
+    auto data = ::lseek(fd, static_cast<::off_t>(offset), SEEK_DATA);
+    if (data < 0) {
+      if (errno == ENXIO) {
+        data = static_cast<::off_t>(end);  // Only a hole remains.
+      } else if (errno == EINVAL) {
+        PreadUpdate(crc, fd, offset, end - offset, buf);
+        return;
+      } else {
+        ThrowErrno("lseek SEEK_DATA");
+      }
+    }
+    auto next = std::min(static_cast<std::uint64_t>(data), end);
+    crc.updateZeros(next - offset);
+    offset = next;
+    if (offset == end)
+      break;
+    auto hole = ::lseek(fd, static_cast<::off_t>(offset), SEEK_HOLE);
+    if (hole < 0)
+      ThrowErrno("lseek SEEK_HOLE");
+    next = std::min(static_cast<std::uint64_t>(hole), end);
+    PreadUpdate(crc, fd, offset, next - offset, buf);
+    offset = next;
+  }
+#else
+  PreadUpdate(crc, fd, offset, length, buf);
+#endif
+} // SparseUpdate
+
+/// Reads with SparseUpdate where the CRC can skip zeros.
+void RangeUpdate(CrcLike auto& crc, int fd, std::uint64_t offset,
+                 std::uint64_t length, std::span<std::byte> buf)
+{
+  if constexpr (ZeroExtendable<std::remove_cvref_t<decltype(crc)>>)
+    SparseUpdate(crc, fd, offset, length, buf);
+  else
+    PreadUpdate(crc, fd, offset, length, buf);
+} // RangeUpdate
+
+/// Opens `name` and checks `range` against its size, resolving ToEnd.
+inline FileDesc OpenRange(const std::filesystem::path& name,
+                          FileRange& range)
+{
+  auto fd = OpenRead(name);
+  auto size = FileSize(fd.get());
+  if (range.offset > size)
+    throw std::out_of_range{"file CRC: offset past end of file"};
+  if (range.length == FileRange::ToEnd)
+    range.length = size - range.offset;
+  else if (range.length > size - range.offset)
+    throw std::out_of_range{"file CRC: range past end of file"};
+  return fd;
+} // OpenRange
 
 } // detail
 
-auto FileCrc(const auto& name, detail::CrcLike auto crc) {
+/// Computes the CRC of `range` of a possibly sparse file, reading only its
+/// data and advancing the CRC across holes arithmetically, with the same
+/// result as reading every byte.
+auto SparseFileCrc(const auto& name, detail::ZeroExtendable auto crc,
+                   FileRange range = {},
+                   std::size_t bufSize = detail::FileBufSize)
+{
+  auto fd = detail::OpenRange(std::filesystem::path{name}, range);
+  auto buf = detail::AlignedBuffer{bufSize};
+  detail::SparseUpdate(crc, fd.get(), range.offset, range.length,
+                       std::span{buf.data(), buf.size()});
+  return crc;
+} // SparseFileCrc
+
+inline auto SparseFileCrc(const auto& name)
+{ return SparseFileCrc(name, Known<Crc32IsoHdlc, 8>{}); }
+
+/// Computes the CRC of `range` of a file using up to `threads` threads (0
+/// means one per hardware thread).  The range is split into one part per
+/// thread, each read with pread into its own buffer; the parts' CRCs are
+/// appended in order, giving exactly the sequential result.  Holes in
+/// sparse files are skipped as by SparseFileCrc.  Throws std::out_of_range
+/// if the range extends past the end of the file.
+auto ParallelFileCrc(const auto& name, detail::Appendable auto crc,
+                     FileRange range, unsigned threads = 0,
+                     std::size_t bufSize = detail::FileBufSize)
+{
+  auto fd = detail::OpenRange(std::filesystem::path{name}, range);
+#if defined(POSIX_FADV_SEQUENTIAL)
+  ::posix_fadvise(fd.get(), static_cast<::off_t>(range.offset),
+                  static_cast<::off_t>(range.length), POSIX_FADV_SEQUENTIAL);
+#endif
+  auto n = static_cast<std::size_t>(
+             std::min<std::uint64_t>(detail::NumThreads(threads),
+                                 range.length / detail::MinParallelFileChunk));
+  if (n <= 1) {
+    auto buf = detail::AlignedBuffer{bufSize};
+    detail::RangeUpdate(crc, fd.get(), range.offset, range.length,
+                        std::span{buf.data(), buf.size()});
+    return crc;
+  }
+  auto chunk = range.length / n;
+  chunk -= chunk % 4096;
+  auto crcs = std::vector(n, crc);
+  auto errors = std::vector<std::exception_ptr>(n);
+  auto part = [&](std::size_t i) {
+    return (i + 1 == n) ? (range.length - i * chunk) : chunk;
+  };
+  {
+    auto workers = std::vector<std::jthread>{};
+    workers.reserve(n - 1);
+    for (std::size_t i = 0; i != n; ++i) {
+      auto work = [&, i] {
+        try {
+          auto buf = detail::AlignedBuffer{bufSize};
+          crcs[i].reset();
+          detail::RangeUpdate(crcs[i], fd.get(), range.offset + i * chunk,
+                              part(i), std::span{buf.data(), buf.size()});
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      };
+      if (i + 1 == n)
+        work();
+      else
+        workers.emplace_back(work);
+    }
+  } // join
+  for (auto& e: errors) {
+    if (e)
+      std::rethrow_exception(e);
+  }
+  for (std::size_t i = 0; i != n; ++i)
+    crc.append(crcs[i].value(), part(i));
+  return crc;
+} // ParallelFileCrc
+
+auto ParallelFileCrc(const auto& name, detail::Appendable auto crc,
+                     unsigned threads = 0)
+{ return ParallelFileCrc(name, crc, FileRange{}, threads); }
+
+inline auto ParallelFileCrc(const auto& name, unsigned threads = 0)
+{ return ParallelFileCrc(name, Known<Crc32IsoHdlc, 8>{}, threads); }
+
+namespace detail {
+
+/// Reads up to `buf.size()` bytes, retrying if interrupted; returns 0 at
+/// end of file.
+inline std::size_t ReadSome(int fd, std::span<std::byte> buf) {
+  for (;;) {
+    auto n = ::read(fd, buf.data(), buf.size());
+    if (n >= 0)
+      return static_cast<std::size_t>(n);
+    if (errno != EINTR)
+      ThrowErrno("read");
+  }
+} // ReadSome
+
+inline void WriteAll(int fd, std::span<const std::byte> buf) {
+  while (!buf.empty()) {
+    auto n = ::write(fd, buf.data(), buf.size());
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      ThrowErrno("write");
+    buf = buf.subspan(static_cast<std::size_t>(n));
+  }
+} // WriteAll
+
+} // detail
+
+/// Updates `crc` with everything read from `fd` until end of file.  Works
+/// for any readable descriptor: files, pipes, sockets, and standard input.
+/// The descriptor is not closed.
+auto FdCrc(int fd, detail::CrcLike auto crc, std::size_t bufSize = 1<<20) {
+  auto buf = detail::AlignedBuffer{bufSize};
+  auto span = std::span{buf.data(), buf.size()};
+  while (auto n = detail::ReadSome(fd, span))
+    crc.update(span.first(n));
+  return crc;
+} // FdCrc
+
+inline auto FdCrc(int fd)
+{ return FdCrc(fd, Known<Crc32IsoHdlc, 8>{}); }
+
+/// Copies everything from `in` to `out` until end of file, returning the
+/// CRC of the data.  On Linux the data moves from `in` to `out` with
+/// splice(2), and tee(2) duplicates it into a pipe from which the CRC reads
+/// it, so it is copied into user space only once.  Elsewhere, or where
+/// splice is not supported for these descriptors, the data is read into a
+/// buffer and written out.  Neither descriptor is closed.
+auto TeeCrc(int in, int out, detail::CrcLike auto crc,
+            std::size_t chunk = 1<<16)
+{
+  auto buf = detail::AlignedBuffer{chunk};
+  auto span = std::span{buf.data(), buf.size()};
+  auto copy = [&] {
+    while (auto n = detail::ReadSome(in, span)) {
+      crc.update(span.first(n));
+      detail::WriteAll(out, span.first(n));
+    }
+    return crc;
+  }; // copy
+#if defined(__linux__)
+  auto makePipe = [](detail::FileDesc& r, detail::FileDesc& w) {
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC) != 0)
+      detail::ThrowErrno("pipe2");
+    r = detail::FileDesc{fds[0]};
+    w = detail::FileDesc{fds[1]};
+  };
+  struct ::stat st;
+  if (::fstat(in, &st) != 0)
+    detail::ThrowErrno("fstat");
+  const auto inIsPipe = S_ISFIFO(st.st_mode);
+  // Data from a non-pipe is first spliced into `p1`; `p2` holds the copy
+  // for the CRC.
+  auto p1r = detail::FileDesc{}, p1w = detail::FileDesc{};
+  auto p2r = detail::FileDesc{}, p2w = detail::FileDesc{};
+  if (!inIsPipe)
+    makePipe(p1r, p1w);
+  makePipe(p2r, p2w);
+  auto moved = false;
+  // Retries interrupted calls; returns -1 where splice is unsupported and
+  // nothing has been moved yet, so the caller can fall back.
+  auto check = [&](::ssize_t n, const char* what) -> ::ssize_t {
+    if (n >= 0)
+      return n;
+    if (errno == EINTR)
+      return -2;
+    if (errno == EINVAL && !moved)
+      return -1;
+    detail::ThrowErrno(what);
+  };
+  // Forwards up to `n` bytes from pipe `src` to `out`, teeing them into
+  // the CRC; returns the number forwarded, 0 at end of file, or -1.
+  auto forward = [&](int src, std::size_t n) -> ::ssize_t {
+    ::ssize_t t;
+    while ((t = check(::tee(src, p2w.get(), n, 0), "tee")) == -2) { }
+    if (t <= 0)
+      return t;
+    for (auto left = static_cast<std::size_t>(t); left != 0; ) {
+      auto m = check(::splice(src, nullptr, out, nullptr, left,
+                              SPLICE_F_MOVE | SPLICE_F_MORE), "splice");
+      if (m == -1)
+        return -1;
+      if (m > 0) {
+        left -= static_cast<std::size_t>(m);
+        moved = true;
+      }
+    }
+    for (auto left = static_cast<std::size_t>(t); left != 0; ) {
+      auto m = detail::ReadSome(p2r.get(), span.first(left));
+      crc.update(span.first(m));
+      left -= m;
+    }
+    return t;
+  }; // forward
+  if (inIsPipe) {
+    for (;;) {
+      auto t = forward(in, chunk);
+      if (t == 0)
+        return crc;
+      if (t < 0)
+        return copy();
+    }
+  }
+  for (;;) {
+    ::ssize_t n;
+    while ((n = check(::splice(in, nullptr, p1w.get(), nullptr, chunk,
+                               SPLICE_F_MOVE), "splice")) == -2)
+      { }
+    if (n == 0)
+      return crc;
+    if (n < 0)
+      return copy();
+    for (auto left = static_cast<std::size_t>(n); left != 0; ) {
+      auto t = forward(p1r.get(), left);
+      if (t < 0) {
+        // `out` does not accept splice: pass on what is already in p1.
+        while (left != 0) {
+          auto m = detail::ReadSome(p1r.get(), span.first(left));
+          crc.update(span.first(m));
+          detail::WriteAll(out, span.first(m));
+          left -= m;
+        }
+        return copy();
+      }
+      left -= static_cast<std::size_t>(t);
+    }
+  }
+#else
+  return copy();
+#endif
+} // TeeCrc
+
+inline auto TeeCrc(int in, int out)
+{ return TeeCrc(in, out, Known<Crc32IsoHdlc, 8>{}); }
+
+#endif // TJG_CRC_POSIX
+
+namespace detail {
+
+/// Updates `crc` with the contents of `name`, read through `buf`, and
+/// returns the number of bytes read.  On POSIX, a CRC that can skip zeros
+/// reads only the data of a sparse regular file, as SparseUpdate does, and
+/// reads anything else, such as a FIFO, until end of file.  Otherwise
+/// the file is read through a stream given a token buffer of its own, so
+/// that it allocates none; reads of `buf` bypass it.
+std::uint64_t StreamUpdate(CrcLike auto& crc, const auto& name,
+                           std::span<std::byte> buf)
+{
+#if defined(TJG_CRC_POSIX)
+  if constexpr (ZeroExtendable<std::remove_cvref_t<decltype(crc)>>) {
+    // Strings and paths are opened as they are, without a temporary path.
+    auto fd = [&] {
+      if constexpr (requires { { name.c_str() } -> std::same_as<const char*>; })
+        return OpenRead(name.c_str());
+      else
+        return OpenRead(name);
+    }();
+    struct ::stat st;
+    if (::fstat(fd.get(), &st) != 0)
+      ThrowErrno("fstat");
+    auto size = std::uint64_t{0};
+    if (S_ISREG(st.st_mode)) {
+      size = static_cast<std::uint64_t>(st.st_size);
+      SparseUpdate(crc, fd.get(), 0, size, buf);
+    } else {
+      while (auto n = ReadSome(fd.get(), buf)) {  // A pipe or a device.
+        crc.update(buf.first(n));
+        size += n;
+      }
+    }
+    return size;
+  }
+#endif
+  char token[8];
   auto in = std::ifstream{};
+  in.rdbuf()->pubsetbuf(token, sizeof(token));
   in.exceptions(std::ios::failbit | std::ios::badbit);
   in.open(name, std::ios::in | std::ios::binary);
   in.exceptions(std::ios::badbit);
-  auto buf = std::vector<char>{};
-  buf.resize(1<<20);
+  auto size = std::uint64_t{0};
   while (!in.eof()) {
     in.clear();
-    in.read(buf.data(), std::ssize(buf));
+    in.read(reinterpret_cast<char*>(buf.data()), std::ssize(buf));
     auto got = static_cast<std::size_t>(in.gcount());
-    crc.update(std::as_bytes(std::span{buf.data(), got}));
+    crc.update(buf.first(got));
+    size += got;
   }
   in.clear();
   in.exceptions(std::ios::failbit | std::ios::badbit);
   in.close();
+  return size;
+} // StreamUpdate
+
+} // detail
+
+/// Computes the CRC of a file, reading through a buffer from `mr`, such as
+/// a BufferPool, so that repeated calls need not allocate.
+auto FileCrc(const auto& name, detail::CrcLike auto crc,
+             std::pmr::memory_resource& mr,
+             std::size_t bufSize = detail::FileBufSize)
+{
+  auto buf = detail::AlignedBuffer{bufSize, &mr};
+  detail::StreamUpdate(crc, name, std::span{buf.data(), buf.size()});
+  return crc;
+} // FileCrc
+
+auto FileCrc(const auto& name, detail::CrcLike auto crc) {
+  auto buf = detail::AlignedBuffer{detail::FileBufSize};
+  detail::StreamUpdate(crc, name, std::span{buf.data(), buf.size()});
   return crc;
 } // FileCrc
 
 inline auto FileCrc(const auto& name)
 { return FileCrc(name, Known<Crc32IsoHdlc, 8>{}); }
 
-inline auto FileCksum(const auto& name) {
-  auto crc = FileCrc(name, Known<Crc32Cksum, 8>{});
-  auto size = std::filesystem::file_size(name);
-  while (size != 0) {
-    crc.update(static_cast<std::byte>(size & 0xff));
-    size >>= 8;
-  }
+inline auto FileCrc(const auto& name, std::pmr::memory_resource& mr)
+{ return FileCrc(name, Known<Crc32IsoHdlc, 8>{}, mr); }
+
+inline auto FileCksum(const auto& name, std::pmr::memory_resource& mr) {
+  auto crc = Known<Crc32Cksum, 8>{};
+  auto buf = detail::AlignedBuffer{detail::FileBufSize, &mr};
+  auto size = detail::StreamUpdate(crc, name,
+                                   std::span{buf.data(), buf.size()});
+  detail::AppendLength(crc, size);
   return crc;
 }
 
+inline auto FileCksum(const auto& name)
+{ return FileCksum(name, *std::pmr::new_delete_resource()); }
+
 } // tjg::crc
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "crc/CrcFile.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <bit>
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(TJG_CRC_POSIX)
+#include <sys/file.h>
+
+namespace tjg::crc {
+
+/// A persistent cache of whole-file CRCs, shared through a memory-mapped
+/// file by any number of threads and processes.  Entries are keyed by the
+/// file's device, inode, size, mtime and ctime and by the algorithm, so
+/// any change to a file, or its replacement, misses; a file's entry is
+/// overwritten when its new CRC is stored.  Files modified within RacyNs
+/// of being checksummed are not cached, since their mtime may not yet
+/// reflect the modification.
+///
+/// The table has a fixed number of 64-byte slots, each guarded by a
+/// sequence lock: readers never block, and writers pass over busy slots,
+/// so the cache is best-effort.  A writer that dies mid-write, between
+/// marking its slot busy and releasing it, leaves the slot busy for good.
+/// Readers and writers then skip it, so the cache loses that slot, but no
+/// entry is corrupted.  Removing the cache file recovers the slot.
+class CrcCache {
+public:
+  static constexpr std::int64_t RacyNs = std::int64_t{2'000'000'000};
+
+  struct Key {
+    std::uint64_t dev = 0;
+    std::uint64_t ino = 0;
+    std::uint64_t size = 0;
+    std::int64_t mtimeNs = 0;
+    std::int64_t ctimeNs = 0;
+    std::uint64_t algorithm = 0;
+  }; // Key
+
+  /// Identifies an algorithm by a 64-bit FNV-1a hash of its name.
+  static constexpr std::uint64_t Algorithm(std::string_view name) noexcept {
+    auto h = std::uint64_t{0xcbf2'9ce4'8422'2325};
+    for (auto c: name) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 0x100'0000'01b3;
+    }
+    return h | 1;  // Zero marks an empty slot.
+  }
+
+  static Key MakeKey(const detail::FileStat& st,
+                     std::string_view algorithm) noexcept
+  {
+    return Key{st.dev, st.ino, st.size, st.mtimeNs, st.ctimeNs,
+               Algorithm(algorithm)};
+  }
+
+private:
+  static constexpr std::uint64_t Magic = 0x5843'4352'4347'4a54;  // TJGCRCCX
+  static constexpr std::uint32_t Version = 1;
+  static constexpr unsigned Probes = 8;
+
+  struct Header {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t slots;
+    std::uint64_t pad[6];
+  }; // Header
+
+  struct Slot {
+    std::uint64_t seq;  ///< Odd while being written.
+    std::uint64_t dev, ino, size, mtimeNs, ctimeNs, algorithm, value;
+  }; // Slot
+  static_assert(sizeof(Header) == 64 && sizeof(Slot) == 64);
+
+  detail::FileDesc _fd;
+  void* _map = MAP_FAILED;
+  std::size_t _mapSize = 0;
+  Slot* _slots = nullptr;
+  std::uint32_t _mask = 0;
+
+  static std::uint64_t Load(const std::uint64_t& x) noexcept {
+    return std::atomic_ref{const_cast<std::uint64_t&>(x)}
+             .load(std::memory_order_relaxed);
+  }
+  static void Store(std::uint64_t& x, std::uint64_t v) noexcept
+    { std::atomic_ref{x}.store(v, std::memory_order_relaxed); }
+
+  static std::uint64_t Hash(const Key& k) noexcept {
+    auto h = k.dev * 0x9e37'79b9'7f4a'7c15 ^ k.ino;
+    h = (h ^ (h >> 29)) * 0xbf58'476d'1ce4'e5b9 ^ k.algorithm;
+    return h ^ (h >> 32);
+  }
+
+  /// Whether `s` holds an entry for the same file and algorithm as `k`.
+  static bool SameFile(const Slot& s, const Key& k) noexcept {
+    return Load(s.dev) == k.dev && Load(s.ino) == k.ino
+        && Load(s.algorithm) == k.algorithm;
+  }
+
+public:
+  /// Opens the cache in `file`, creating it with `slots` slots (rounded up
+  /// to a power of two) if it does not exist.  An existing cache keeps its
+  /// size.  Throws std::system_error on I/O errors and std::runtime_error
+  /// if the file is not a cache.
+  explicit CrcCache(const std::filesystem::path& file,
+                    std::uint32_t slots = std::uint32_t{1} << 16)
+  {
+    auto fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+      detail::ThrowErrno("open");
+    _fd = detail::FileDesc{fd};
+    // Creation is serialized between processes.
+    if (::flock(fd, LOCK_EX) != 0)
+      detail::ThrowErrno("flock");
+    auto header = Header{};
+    auto got = ::pread(fd, &header, sizeof(header), 0);
+    if (got == 0) {
+      slots = std::bit_ceil(std::max(slots, Probes));
+      header = Header{Magic, Version, slots, {}};
+      if (::ftruncate(fd, static_cast<::off_t>(sizeof(Header)
+                                       + std::uint64_t{slots} * sizeof(Slot)))
+          != 0
+          || ::pwrite(fd, &header, sizeof(header), 0)
+             != static_cast<::ssize_t>(sizeof(header)))
+      {
+        auto err = errno;
+        ::flock(fd, LOCK_UN);
+        errno = err;
+        detail::ThrowErrno("CrcCache: initialize");
+      }
+    }
+    ::flock(fd, LOCK_UN);
+    if (got < 0)
+      detail::ThrowErrno("pread");
+    if ((got != 0 && got != static_cast<::ssize_t>(sizeof(header)))
+        || header.magic != Magic || header.version != Version
+        || !std::has_single_bit(header.slots) || header.slots < Probes)
+    {
+      throw std::runtime_error{"CrcCache: not a CRC cache"};
+    }
+    _mapSize = sizeof(Header) + std::size_t{header.slots} * sizeof(Slot);
+    if (detail::FileSize(fd) < _mapSize)
+      throw std::runtime_error{"CrcCache: truncated"};
+    _map = ::mmap(nullptr, _mapSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  fd, 0);
+    if (_map == MAP_FAILED)
+      detail::ThrowErrno("mmap");
+    _slots = reinterpret_cast<Slot*>(static_cast<char*>(_map)
+                                     + sizeof(Header));
+    _mask = header.slots - 1;
+  } // ctor
+
+  CrcCache(const CrcCache&) = delete;
+  CrcCache& operator=(const CrcCache&) = delete;
+
+  ~CrcCache() {
+    if (_map != MAP_FAILED)
+      ::munmap(_map, _mapSize);
+  }
+
+  std::uint32_t slots() const noexcept { return _mask + 1; }
+
+  /// The cached CRC for `k`, if any.
+  std::optional<std::uint64_t> find(const Key& k) const noexcept {
+    auto h = Hash(k);
+    for (unsigned i = 0; i != Probes; ++i) {
+      const auto& s = _slots[(h + i) & _mask];
+      auto seq = std::atomic_ref{const_cast<std::uint64_t&>(s.seq)};
+      auto before = seq.load(std::memory_order_acquire);
+      if (before & 1)
+        continue;
+      auto match = SameFile(s, k) && Load(s.size) == k.size
+                && Load(s.mtimeNs) == static_cast<std::uint64_t>(k.mtimeNs)
+                && Load(s.ctimeNs) == static_cast<std::uint64_t>(k.ctimeNs);
+      auto value = Load(s.value);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (match && seq.load(std::memory_order_relaxed) == before)
+        return value;
+    }
+    return std::nullopt;
+  } // find
+
+  /// Stores `value` as the CRC for `k`, replacing any entry for the same
+  /// file and algorithm, else filling an empty slot, else evicting the
+  /// first.  Busy slots are passed over; if every slot probed is busy,
+  /// nothing is stored.
+  void insert(const Key& k, std::uint64_t value) noexcept {
+    auto h = Hash(k);
+    Slot* target = nullptr;
+    for (unsigned i = 0; i != Probes; ++i) {
+      auto& s = _slots[(h + i) & _mask];
+      if (Load(s.seq) & 1)
+        continue;
+      if (SameFile(s, k) || Load(s.algorithm) == 0) {
+        target = &s;
+        break;
+      }
+      if (!target)
+        target = &s;
+    }
+    if (!target)
+      return;
+    auto seq = std::atomic_ref{target->seq};
+    auto before = seq.load(std::memory_order_relaxed);
+    if ((before & 1)
+        || !seq.compare_exchange_strong(before, before + 1,
+                                        std::memory_order_acquire))
+    {
+      return;  // Another writer has the slot.
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    Store(target->dev, k.dev);
+    Store(target->ino, k.ino);
+    Store(target->size, k.size);
+    Store(target->mtimeNs, static_cast<std::uint64_t>(k.mtimeNs));
+    Store(target->ctimeNs, static_cast<std::uint64_t>(k.ctimeNs));
+    Store(target->algorithm, k.algorithm);
+    Store(target->value, value);
+    seq.store(before + 2, std::memory_order_release);
+  } // insert
+
+  /// Whether a file last modified at `mtimeNs` is too recent to cache.
+  static bool Racy(std::int64_t mtimeNs) noexcept {
+    using namespace std::chrono;
+    auto now = duration_cast<nanoseconds>(
+                 system_clock::now().time_since_epoch()).count();
+    return mtimeNs + RacyNs >= now;
+  }
+}; // CrcCache
+
+namespace detail {
+
+/// Updates `crc` with the contents of `name`, consulting `cache` first and
+/// storing the CRC afterward.  Returns the file's size.
+std::uint64_t CachedUpdate(Appendable auto& crc,
+                           const std::filesystem::path& name,
+                           CrcCache& cache)
+{
+  using Crc = std::remove_cvref_t<decltype(crc)>;
+  auto key = CrcCache::MakeKey(Stat(name), Crc::Name);
+  if (auto v = cache.find(key)) {
+    crc.append(static_cast<typename Crc::value_type>(*v), key.size);
+    return key.size;
+  }
+  auto fd = OpenRead(name);
+  auto st = Stat(fd.get());
+  auto whole = Crc{};
+  auto buf = AlignedBuffer{FileBufSize};
+  RangeUpdate(whole, fd.get(), 0, st.size, std::span{buf.data(), buf.size()});
+  // Cache only a file that did not change while it was read.
+  if (Stat(fd.get()) == st && !CrcCache::Racy(st.mtimeNs))
+    cache.insert(CrcCache::MakeKey(st, Crc::Name), whole.value());
+  crc.append(whole.value(), st.size);
+  return st.size;
+} // CachedUpdate
+
+} // detail
+
+/// Like FileCrc, but returns the CRC from `cache` if the file is unchanged
+/// since it was cached, at the cost of one stat(2), and otherwise reads the
+/// file and caches its CRC.
+auto FileCrc(const auto& name, detail::Appendable auto crc, CrcCache& cache)
+{
+  detail::CachedUpdate(crc, std::filesystem::path{name}, cache);
+  return crc;
+} // FileCrc
+
+inline auto FileCrc(const auto& name, CrcCache& cache)
+{ return FileCrc(name, Known<Crc32IsoHdlc, 8>{}, cache); }
+
+inline auto FileCksum(const auto& name, CrcCache& cache) {
+  auto crc = Known<Crc32Cksum, 8>{};
+  auto size = detail::CachedUpdate(crc, std::filesystem::path{name}, cache);
+  detail::AppendLength(crc, size);
+  return crc;
+}
+
+} // tjg::crc
+
+#endif // TJG_CRC_POSIX
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "crc/CrcFile.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <span>
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(TJG_CRC_POSIX)
+
+namespace tjg::crc {
+
+/// Maintains the CRC of a file incrementally, using a sidecar file that
+/// holds the CRC of every `blockSize` block together with the size, inode,
+/// and modification time of the file when it was indexed.  The whole-file
+/// CRC is the blocks' CRCs appended in order.
+///
+/// update() reads nothing if the file is unchanged.  Otherwise, it rereads
+/// every block, unless the caller says which byte ranges changed since the
+/// index was last updated, in which case it rereads only the blocks that
+/// overlap them, plus any blocks whose length changed.  A file that was
+/// replaced, rather than modified in place, is always reread in full.  A
+/// file modified within RacyNs of being indexed is treated as changed,
+/// since its mtime may not yet reflect the modification.
+template<class Traits_, std::size_t Slices_ = MaxSlices>
+class FileCrcIndex {
+public:
+  using Traits = Traits_;
+  using Crc = Known<Traits_, Slices_>;
+  using value_type = Crc::value_type;
+
+  static constexpr std::uint64_t DefaultBlockSize = std::uint64_t{1} << 20;
+  static constexpr std::int64_t RacyNs = std::int64_t{2'000'000'000};
+
+private:
+  static constexpr std::array<char, 8> Magic
+                     {'T', 'J', 'G', 'C', 'R', 'C', 'I', 'X'};
+  static constexpr std::uint64_t Version = 1;
+
+  std::filesystem::path _file;
+  std::filesystem::path _sidecar;
+  std::uint64_t _blockSize;
+  detail::FileStat _stat;
+  std::int64_t _indexedNs = 0;
+  std::vector<value_type> _crcs;
+  value_type _value = Crc{}.value();
+  std::uint64_t _blocksRead = 0;
+
+  static std::int64_t Now() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(
+             system_clock::now().time_since_epoch()).count();
+  }
+
+  /// Parameters that must match for a sidecar to be used.
+  std::array<std::uint64_t, 7> params() const noexcept {
+    auto a = detail::AlgorithmParams<Traits>();
+    return {Version, a[0], a[1], a[2], a[3], a[4], _blockSize};
+  }
+
+  std::uint64_t blockCount(std::uint64_t size) const noexcept
+    { return size / _blockSize + (size % _blockSize != 0); }
+
+  std::uint64_t blockLength(std::uint64_t k, std::uint64_t size) const
+                            noexcept
+    { return std::min(_blockSize, size - k * _blockSize); }
+
+  /// Loads the sidecar; false if it is missing, corrupt, or was made with
+  /// other parameters.
+  bool load() {
+    auto in = std::ifstream{_sidecar, std::ios::in | std::ios::binary};
+    if (!in)
+      return false;
+    auto magic = decltype(Magic){};
+    if (!in.read(magic.data(), magic.size()) || magic != Magic)
+      return false;
+    for (auto p: params()) {
+      std::uint64_t x;
+      if (!detail::GetLe64(in, x) || x != p)
+        return false;
+    }
+    auto fields = std::array<std::uint64_t, 6>{};
+    for (auto& x: fields) {
+      if (!detail::GetLe64(in, x))
+        return false;
+    }
+    auto [dev, ino, size, mtime, indexed, count] = fields;
+    // The CRCs must exactly fill the rest of the sidecar.
+    auto here = in.tellg();
+    if (!in.seekg(0, std::ios::end))
+      return false;
+    auto left = static_cast<std::uint64_t>(in.tellg() - here);
+    if (count != blockCount(size) || left % 8 != 0 || count != left / 8
+        || !in.seekg(here))
+    {
+      return false;
+    }
+    auto crcs = std::vector<value_type>{};
+    crcs.reserve(static_cast<std::size_t>(count));
+    for (std::uint64_t k = 0; k != count; ++k) {
+      std::uint64_t x;
+      if (!detail::GetLe64(in, x))
+        return false;
+      crcs.push_back(static_cast<value_type>(x));
+    }
+    _stat = detail::FileStat{dev, ino, size,
+                             static_cast<std::int64_t>(mtime), 0};
+    _indexedNs = static_cast<std::int64_t>(indexed);
+    _crcs = std::move(crcs);
+    return true;
+  } // load
+
+  /// Writes the sidecar atomically, through a temporary of its own.
+  void save() const {
+    detail::AtomicWrite(_sidecar, [&](std::ostream& out) {
+      out.write(Magic.data(), Magic.size());
+      for (auto p: params())
+        detail::PutLe64(out, p);
+      detail::PutLe64(out, _stat.dev);
+      detail::PutLe64(out, _stat.ino);
+      detail::PutLe64(out, _stat.size);
+      detail::PutLe64(out, static_cast<std::uint64_t>(_stat.mtimeNs));
+      detail::PutLe64(out, static_cast<std::uint64_t>(_indexedNs));
+      detail::PutLe64(out, _crcs.size());
+      for (auto c: _crcs)
+        detail::PutLe64(out, c);
+    });
+  } // save
+
+public:
+  /// Indexes `file` using `sidecar`, by default the file's name with
+  /// ".crcidx" appended.  Nothing is read until update().
+  explicit FileCrcIndex(std::filesystem::path file,
+                        std::filesystem::path sidecar = {},
+                        std::uint64_t blockSize = DefaultBlockSize)
+    : _file{std::move(file)}
+    , _sidecar{std::move(sidecar)}
+    , _blockSize{blockSize}
+  {
+    if (blockSize == 0)
+      throw std::invalid_argument{"FileCrcIndex: zero block size"};
+    if (_sidecar.empty()) {
+      _sidecar = _file;
+      _sidecar += ".crcidx";
+    }
+  } // ctor
+
+  /// Brings the index and its sidecar up to date and returns the CRC of
+  /// the whole file.  `dirty`, if not empty, lists every byte range that
+  /// has changed since the last update; the caller vouches that nothing
+  /// else has.
+  value_type update(std::span<const FileRange> dirty = {}) {
+    auto fd = detail::OpenRead(_file);
+    auto st = detail::Stat(fd.get());
+    auto count = blockCount(st.size);
+    auto stale = std::vector<bool>(static_cast<std::size_t>(count), true);
+    // Nothing is kept for a file that was replaced, even if the caller
+    // lists what changed.
+    if (load() && st.dev == _stat.dev && st.ino == _stat.ino) {
+      auto unchanged = st.size == _stat.size && st.mtimeNs == _stat.mtimeNs
+                    && st.mtimeNs + RacyNs < _indexedNs;
+      if (unchanged || !dirty.empty()) {
+        auto keep = std::min<std::uint64_t>(count, _crcs.size());
+        for (std::uint64_t k = 0; k != keep; ++k)
+          stale[k] = (blockLength(k, st.size) != blockLength(k, _stat.size));
+        for (const auto& r: dirty) {
+          if (r.offset >= st.size)
+            continue;
+          auto last = (r.length < st.size - r.offset) ? r.offset + r.length
+                                                      : st.size;
+          for (auto k = r.offset / _blockSize; k * _blockSize < last; ++k)
+            stale[k] = true;
+        }
+      }
+    }
+    _crcs.resize(static_cast<std::size_t>(count));
+    _blocksRead = 0;
+    auto buf = detail::AlignedBuffer{detail::FileBufSize};
+    for (std::uint64_t k = 0; k != count; ++k) {
+      if (!stale[k])
+        continue;
+      auto c = Crc{};
+      detail::RangeUpdate(c, fd.get(), k * _blockSize,
+                          blockLength(k, st.size),
+                          std::span{buf.data(), buf.size()});
+      _crcs[k] = c.value();
+      ++_blocksRead;
+    }
+    auto whole = Crc{};
+    for (std::uint64_t k = 0; k != count; ++k)
+      whole.append(_crcs[k], blockLength(k, st.size));
+    _value = whole.value();
+    // A modification during the scan leaves a later mtime, so the next
+    // update rescans.
+    _stat = st;
+    _indexedNs = Now();
+    save();
+    return _value;
+  } // update
+
+  value_type value() const noexcept { return _value; }
+  std::uint64_t blockSize() const noexcept { return _blockSize; }
+  const std::filesystem::path& sidecar() const noexcept { return _sidecar; }
+
+  /// Number of blocks read by the last update().
+  std::uint64_t blocksRead() const noexcept { return _blocksRead; }
+
+  /// CRCs of the blocks as of the last update().
+  std::span<const value_type> blockCrcs() const noexcept { return _crcs; }
+}; // FileCrcIndex
+
+} // tjg::crc
+
+#endif // TJG_CRC_POSIX
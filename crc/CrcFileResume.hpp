@@ -0,0 +1,151 @@
+#pragma once
+
+#include "crc/CrcFile.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <array>
+#include <span>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(TJG_CRC_POSIX)
+
+namespace tjg::crc {
+
+/// Maintains the CRC of a growing, append-only file, such as a log, so that
+/// each update() reads only the bytes appended since the last.  A state
+/// file (by default the file's name with ".crcstate" appended) records the
+/// file's identity, the length covered, and the CRC checkpoint at that
+/// length, along with the CRC of the AnchorSize bytes preceding it.  If the
+/// file was replaced, truncated, or rewritten in place (as far as the
+/// anchor can tell), the CRC is recomputed from the start.
+template<class Traits_, std::size_t Slices_ = MaxSlices>
+class ResumableFileCrc {
+public:
+  using Traits = Traits_;
+  using Crc = Known<Traits_, Slices_>;
+  using value_type = Crc::value_type;
+
+  static constexpr std::uint64_t AnchorSize = 4096;
+
+private:
+  static constexpr std::array<char, 8> Magic
+                     {'T', 'J', 'G', 'C', 'R', 'C', 'S', 'T'};
+  static constexpr std::uint64_t Version = 1;
+
+  /// The persisted state.
+  struct State {
+    std::uint64_t dev = 0;
+    std::uint64_t ino = 0;
+    std::uint64_t length = 0;
+    std::uint64_t crc = 0;
+    std::uint64_t anchor = 0;  ///< CRC of the bytes preceding `length`.
+  }; // State
+
+  std::filesystem::path _file;
+  std::filesystem::path _stateFile;
+  value_type _value = Crc{}.value();
+  std::uint64_t _length = 0;
+  std::uint64_t _bytesRead = 0;
+
+  bool load(State& state) const {
+    auto in = std::ifstream{_stateFile, std::ios::in | std::ios::binary};
+    if (!in)
+      return false;
+    auto magic = decltype(Magic){};
+    if (!in.read(magic.data(), magic.size()) || magic != Magic)
+      return false;
+    std::uint64_t x;
+    if (!detail::GetLe64(in, x) || x != Version)
+      return false;
+    for (auto p: detail::AlgorithmParams<Traits>()) {
+      if (!detail::GetLe64(in, x) || x != p)
+        return false;
+    }
+    return detail::GetLe64(in, state.dev) && detail::GetLe64(in, state.ino)
+        && detail::GetLe64(in, state.length) && detail::GetLe64(in, state.crc)
+        && detail::GetLe64(in, state.anchor);
+  } // load
+
+  /// Writes the state file atomically, through a temporary of its own.
+  void save(const State& state) const {
+    detail::AtomicWrite(_stateFile, [&](std::ostream& out) {
+      out.write(Magic.data(), Magic.size());
+      detail::PutLe64(out, Version);
+      for (auto p: detail::AlgorithmParams<Traits>())
+        detail::PutLe64(out, p);
+      for (auto x: {state.dev, state.ino, state.length, state.crc,
+                    state.anchor})
+      {
+        detail::PutLe64(out, x);
+      }
+    });
+  } // save
+
+  /// CRC of the AnchorSize bytes, or fewer, preceding `length`.
+  static value_type Anchor(int fd, std::uint64_t length,
+                           std::span<std::byte> buf)
+  {
+    auto n = std::min(length, AnchorSize);
+    auto c = Crc{};
+    detail::PreadUpdate(c, fd, length - n, n, buf);
+    return c.value();
+  }
+
+public:
+  explicit ResumableFileCrc(std::filesystem::path file,
+                            std::filesystem::path stateFile = {})
+    : _file{std::move(file)}, _stateFile{std::move(stateFile)}
+  {
+    if (_stateFile.empty()) {
+      _stateFile = _file;
+      _stateFile += ".crcstate";
+    }
+  } // ctor
+
+  /// Extends the CRC over the bytes appended since the last update, saves
+  /// the new state, and returns the CRC of the whole file.
+  value_type update() {
+    auto fd = detail::OpenRead(_file);
+    auto st = detail::Stat(fd.get());
+    auto buf = detail::AlignedBuffer{detail::FileBufSize};
+    auto span = std::span{buf.data(), buf.size()};
+    auto state = State{};
+    auto crc = Crc{};
+    if (load(state) && state.dev == st.dev && state.ino == st.ino
+        && state.length <= st.size
+        && Anchor(fd.get(), state.length, span) == state.anchor)
+    {
+      crc.restore(static_cast<value_type>(state.crc));
+    } else {
+      state.length = 0;
+    }
+    detail::PreadUpdate(crc, fd.get(), state.length, st.size - state.length,
+                        span);
+    _bytesRead = st.size - state.length;
+    _length = st.size;
+    _value = crc.value();
+    save(State{st.dev, st.ino, st.size, _value,
+               Anchor(fd.get(), st.size, span)});
+    return _value;
+  } // update
+
+  value_type value() const noexcept { return _value; }
+
+  /// Length of the file covered by value().
+  std::uint64_t length() const noexcept { return _length; }
+
+  /// Number of bytes of the file read by the last update(), not counting
+  /// the anchor.
+  std::uint64_t bytesRead() const noexcept { return _bytesRead; }
+
+  const std::filesystem::path& stateFile() const noexcept
+    { return _stateFile; }
+}; // ResumableFileCrc
+
+} // tjg::crc
+
+#endif // TJG_CRC_POSIX
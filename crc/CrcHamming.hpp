@@ -0,0 +1,326 @@
+#pragma once
+
+#include "crc/CrcParallel.hpp"
+
+#include "tjg/Integer.hpp"
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+namespace tjg::crc {
+
+/// Error-detection strength of a CRC polynomial at one data-word length.
+struct HammingResult {
+  std::uint64_t dataBits;   ///< Data-word length in bits.
+  unsigned hd;              ///< Hamming distance, or maxWeight+1 if no
+                            ///< error of weight <= maxWeight is undetected.
+  std::uint64_t undetected; ///< Number of undetected errors of weight hd.
+}; // HammingResult
+
+namespace detail {
+
+/// Fewest pairs of bits worth a thread of its own.  Each pair costs a
+/// table probe, from a few ns up to about 30 ns once the table outgrows the
+/// cache, so 2^16 pairs is at least a few hundred us: over ten times the
+/// ~20 us it takes to start and join a thread (see MinParallelChunk).
+constexpr std::uint64_t MinParallelPairs = std::uint64_t{1} << 16;
+
+/// Pair syndromes held in memory at once while counting weight-4 and
+/// weight-5 errors; larger searches are split into passes.
+constexpr std::uint64_t MaxPairsPerPass = std::uint64_t{1} << 24;
+
+/// Syndromes of at most this many bits index tables directly.
+constexpr std::size_t MaxDirectBits = 20;
+
+/// Runs f(t) for t in [0, n), on n threads.
+template<class F>
+void RunThreads(unsigned n, F&& f) {
+  auto workers = std::vector<std::jthread>{};
+  workers.reserve(n - 1);
+  for (unsigned t = 0; t + 1 < n; ++t)
+    workers.emplace_back(f, t);
+  f(n - 1);
+} // RunThreads
+
+constexpr std::uint64_t HashMix(std::uint64_t v) noexcept
+  { return (v * 0x9e37'79b9'7f4a'7c15u) >> 32; }
+
+} // detail
+
+/// Koopman-style evaluator of the Hamming distance (HD) of a CRC polynomial
+/// as a function of data-word length, with the number of undetected errors
+/// at that weight.  `poly` has the usual normal form, without the x^Bits
+/// term; reflection does not change the HD.
+///
+/// An error pattern is undetected if it is a multiple of the generator, so
+/// the search works on the syndromes x^i mod P of the codeword's bits:
+/// weights 2 and 3 by sorting and hashing, and weights 4 and 5 by matching
+/// the syndromes of pairs of bits against each other, O(n^2) and O(n^3)
+/// respectively for n-bit codewords.  Odd weights are skipped for
+/// generators divisible by x+1, which detect all of them.  Work is spread
+/// over `threads` threads (0 means one per hardware thread).
+template<std::size_t Bits_>
+requires (Bits_ >= 3 && Bits_ <= 64)
+class HammingEvaluator {
+public:
+  static constexpr auto Bits = Bits_;
+  static constexpr unsigned MaxWeight = 5;
+
+  using value_type = uint_t<Bits>::least;
+
+private:
+  using Syndromes = std::vector<std::uint64_t>;
+
+  static constexpr bool Direct = (Bits <= detail::MaxDirectBits);
+
+  value_type _poly;
+  unsigned _threads;
+  bool _parity;   ///< Is the generator divisible by x+1?
+
+  /// x^i mod P, for i in [0, n).
+  Syndromes syndromes(std::uint64_t n) const {
+    constexpr auto Mask = ~std::uint64_t{0} >> (64 - Bits);
+    auto s = Syndromes(n);
+    auto r = std::uint64_t{1};
+    for (auto& x: s) {
+      x = r;
+      auto top = (r >> (Bits - 1)) & 1;
+      r = (r << 1) & Mask;
+      if (top)
+        r ^= _poly;
+    }
+    return s;
+  } // syndromes
+
+  unsigned threads(std::uint64_t work) const noexcept {
+    auto n = std::min<std::uint64_t>(_threads,
+                                     work / detail::MinParallelPairs);
+    return static_cast<unsigned>(std::max<std::uint64_t>(n, 1));
+  }
+
+  /// Weight 2: pairs of bits with equal syndromes.
+  static std::uint64_t Weight2(Syndromes s) {
+    std::ranges::sort(s);
+    auto count = std::uint64_t{0};
+    for (std::size_t i = 0, j; i != s.size(); i = j) {
+      for (j = i + 1; j != s.size() && s[j] == s[i]; ++j) { }
+      count += (j - i) * (j - i - 1) / 2;
+    }
+    return count;
+  } // Weight2
+
+  /// Weight 3: s[i] ^ s[j] == s[k] for i < j < k.  Syndromes are distinct.
+  std::uint64_t weight3(const Syndromes& s) const {
+    constexpr auto Empty = ~std::uint64_t{0};
+    auto n = s.size();
+    // Open-addressed syndrome -> index table, indexed directly by narrow
+    // syndromes.
+    auto bits = Direct ? Bits : std::bit_width(2 * n);
+    auto table = std::vector<std::uint64_t>(std::size_t{1} << bits, Empty);
+    auto mask = table.size() - 1;
+    auto slot = [&](std::uint64_t v) {
+      if constexpr (Direct)
+        return static_cast<std::size_t>(v);
+      else
+        return static_cast<std::size_t>(detail::HashMix(v)) & mask;
+    };
+    for (std::size_t k = 0; k != n; ++k) {
+      auto i = slot(s[k]);
+      while (table[i] != Empty)
+        i = (i + 1) & mask;
+      table[i] = k;
+    }
+    auto total = std::atomic<std::uint64_t>{0};
+    auto nt = threads(n * n / 2);
+    detail::RunThreads(nt, [&](unsigned t) {
+      auto count = std::uint64_t{0};
+      for (std::size_t i = t; i < n; i += nt) {
+        for (std::size_t j = i + 1; j < n; ++j) {
+          auto v = s[i] ^ s[j];
+          for (auto h = slot(v); table[h] != Empty; h = (h + 1) & mask) {
+            if (s[table[h]] == v) {
+              count += (table[h] > j);
+              break;
+            }
+          }
+        }
+      }
+      total += count;
+    });
+    return total;
+  } // weight3
+
+  /// Number of passes needed to hold the pair syndromes of `s`.
+  static std::uint64_t Passes(const Syndromes& s) noexcept {
+    auto pairs = std::uint64_t{s.size()} * (s.size() - 1) / 2;
+    return std::max<std::uint64_t>(
+      (pairs + detail::MaxPairsPerPass - 1) / detail::MaxPairsPerPass, 1);
+  }
+
+  /// Sorted syndromes of the pairs of bits whose syndrome hashes to `pass`.
+  static Syndromes PairSyndromes(const Syndromes& s,
+                                 std::uint64_t pass, std::uint64_t passes)
+  {
+    auto pairs = Syndromes{};
+    auto n = s.size();
+    pairs.reserve(n * (n - 1) / 2 / passes + n);
+    for (std::size_t i = 0; i != n; ++i) {
+      for (std::size_t j = i + 1; j != n; ++j) {
+        auto v = s[i] ^ s[j];
+        if (passes == 1 || detail::HashMix(v) % passes == pass)
+          pairs.push_back(v);
+      }
+    }
+    std::ranges::sort(pairs);
+    return pairs;
+  } // PairSyndromes
+
+  /// Weight 4: two disjoint pairs with equal syndromes.  Since there are
+  /// no undetected errors of weight 2 or 3, pairs that match are disjoint,
+  /// and each error is found once for each of its 3 splits into pairs.
+  std::uint64_t weight4(const Syndromes& s) const {
+    auto work = std::uint64_t{s.size()} * s.size() / 2;
+    auto nt = threads(work);
+    if constexpr (Direct) {
+      // Count pair syndromes in place, one array per thread.
+      auto counts = std::vector<std::vector<std::uint64_t>>(nt);
+      auto n = s.size();
+      detail::RunThreads(nt, [&](unsigned t) {
+        auto& c = counts[t];
+        c.assign(std::size_t{1} << Bits, 0);
+        for (std::size_t i = t; i < n; i += nt) {
+          for (std::size_t j = i + 1; j < n; ++j)
+            ++c[s[i] ^ s[j]];
+        }
+      });
+      auto total = std::uint64_t{0};
+      for (std::size_t v = 0; v != counts[0].size(); ++v) {
+        auto m = std::uint64_t{0};
+        for (auto& c: counts)
+          m += c[v];
+        total += m * (m - 1) / 2;
+      }
+      return total / 3;
+    }
+    auto passes = std::max<std::uint64_t>(Passes(s), nt);
+    auto total = std::atomic<std::uint64_t>{0};
+    detail::RunThreads(nt, [&](unsigned t) {
+      auto count = std::uint64_t{0};
+      for (auto pass = std::uint64_t{t}; pass < passes; pass += nt) {
+        auto pairs = PairSyndromes(s, pass, passes);
+        for (std::size_t i = 0, j; i != pairs.size(); i = j) {
+          for (j = i + 1; j != pairs.size() && pairs[j] == pairs[i]; ++j) { }
+          count += (j - i) * (j - i - 1) / 2;
+        }
+      }
+      total += count;
+    });
+    return total / 3;
+  } // weight4
+
+  /// Weight 5: a triple and a disjoint pair with equal syndromes.  Each
+  /// error is found once for each of its 10 splits into a triple and a pair.
+  /// With no undetected errors of weight 2 to 4, pair syndromes are distinct
+  /// and nonzero, so they go in an open-addressed set with 0 for empty.
+  std::uint64_t weight5(const Syndromes& s) const {
+    auto n = s.size();
+    auto passes = Passes(s);
+    auto total = std::atomic<std::uint64_t>{0};
+    for (std::uint64_t pass = 0; pass != passes; ++pass) {
+      auto pairs = PairSyndromes(s, pass, passes);
+      auto set = Syndromes(std::bit_ceil(2 * pairs.size() + 2), 0);
+      auto mask = set.size() - 1;
+      for (auto v: pairs) {
+        auto h = static_cast<std::size_t>(detail::HashMix(v)) & mask;
+        while (set[h] != 0)
+          h = (h + 1) & mask;
+        set[h] = v;
+      }
+      auto nt = threads(std::uint64_t{n} * n * n / 6);
+      detail::RunThreads(nt, [&](unsigned t) {
+        auto count = std::uint64_t{0};
+        for (std::size_t i = t; i < n; i += nt) {
+          for (std::size_t j = i + 1; j < n; ++j) {
+            auto u = s[i] ^ s[j];
+            for (std::size_t k = j + 1; k < n; ++k) {
+              auto v = u ^ s[k];
+              auto mix = detail::HashMix(v);
+              if (passes != 1 && mix % passes != pass)
+                continue;
+              for (auto h = mix & mask; set[h] != 0; h = (h + 1) & mask) {
+                if (set[h] == v) {
+                  ++count;
+                  break;
+                }
+              }
+            }
+          }
+        }
+        total += count;
+      });
+    }
+    return total / 10;
+  } // weight5
+
+public:
+  explicit HammingEvaluator(value_type poly, unsigned threads = 0)
+    : _poly{poly}, _threads{detail::NumThreads(threads)}
+    , _parity{std::popcount(static_cast<std::uint64_t>(poly)) % 2 == 1}
+  {
+    if ((poly & 1) == 0)
+      throw std::invalid_argument{"HammingEvaluator: poly lacks x^0 term"};
+  }
+
+  /// HD and number of undetected errors of that weight for `dataBits` of
+  /// data (plus Bits of CRC), considering errors of weight <= maxWeight.
+  HammingResult evaluate(std::uint64_t dataBits,
+                         unsigned maxWeight = 4) const
+  {
+    if (maxWeight < 2 || maxWeight > MaxWeight)
+      throw std::invalid_argument{"HammingEvaluator: bad maximum weight"};
+    auto s = syndromes(dataBits + Bits);
+    auto result = HammingResult{dataBits, maxWeight + 1, 0};
+    for (unsigned w = 2; w <= maxWeight; ++w) {
+      if (_parity && w % 2 == 1)
+        continue;
+      auto count = (w == 2) ? Weight2(s)
+                 : (w == 3) ? weight3(s)
+                 : (w == 4) ? weight4(s)
+                 :            weight5(s);
+      if (count != 0) {
+        result.hd = w;
+        result.undetected = count;
+        break;
+      }
+    }
+    return result;
+  } // evaluate
+
+  /// Longest data word, up to `maxDataBits`, for which the HD is at least
+  /// `hd`.  The HD never increases with length, so this is a binary search.
+  std::uint64_t maxLength(unsigned hd, std::uint64_t maxDataBits) const {
+    if (hd < 2 || hd > MaxWeight + 1)
+      throw std::invalid_argument{"HammingEvaluator: bad Hamming distance"};
+    if (hd == 2)
+      return maxDataBits;
+    // No error shorter than the CRC is undetected: lo always qualifies.
+    auto lo = std::uint64_t{0};
+    auto hi = maxDataBits + 1;
+    while (hi - lo > 1) {
+      auto mid = lo + (hi - lo) / 2;
+      if (evaluate(mid, hd - 1).hd >= hd)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    return lo;
+  } // maxLength
+}; // HammingEvaluator
+
+} // tjg::crc
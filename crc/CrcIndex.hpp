@@ -0,0 +1,94 @@
+#pragma once
+
+#include "crc/CrcParallel.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <thread>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+namespace tjg::crc {
+
+/// Index over an immutable buffer that answers "CRC of bytes [a, b)"
+/// queries.  It stores the CRC of every prefix that ends on a block
+/// boundary, so a query reads at most two partial blocks and combines the
+/// results.  Memory overhead is one CRC per `blockSize` bytes.
+template<class Traits_, std::size_t Slices_ = MaxSlices>
+class CrcIndex {
+public:
+  using Traits = Traits_;
+  using Crc = Known<Traits_, Slices_>;
+  using value_type = Crc::value_type;
+
+private:
+  std::span<const std::byte> _data;
+  std::size_t _blockSize;
+  std::vector<value_type> _prefix;  ///< _prefix[k] = CRC of k blocks.
+
+  /// CRC of the first `n` bytes.
+  value_type prefix(std::uint64_t n) const {
+    auto k = n / _blockSize;
+    auto start = k * _blockSize;
+    auto tail = Crc{}(_data.subspan(start, n - start)).value();
+    return Crc::Combine(_prefix[k], tail, n - start);
+  }
+
+public:
+  /// Builds the index using up to `threads` threads (0 means one per
+  /// hardware thread).  `data` must outlive the index.
+  explicit CrcIndex(std::span<const std::byte> data,
+                    std::size_t blockSize = std::size_t{1} << 16,
+                    unsigned threads = 0)
+    : _data{data}, _blockSize{blockSize}
+  {
+    if (blockSize == 0)
+      throw std::invalid_argument{"CrcIndex: zero block size"};
+    auto blocks = data.size() / blockSize;
+    _prefix.resize(blocks + 1);
+    auto n = std::min<std::size_t>(detail::NumThreads(threads),
+                     data.size() / std::max(blockSize,
+                                            detail::MinParallelChunk));
+    n = std::max<std::size_t>(n, 1);
+    // Each thread computes the CRCs of a contiguous run of blocks.
+    auto work = [&](std::size_t first, std::size_t last) {
+      for (auto k = first; k != last; ++k)
+        _prefix[k+1] = Crc{}(data.subspan(k * blockSize, blockSize)).value();
+    };
+    {
+      auto workers = std::vector<std::jthread>{};
+      workers.reserve(n - 1);
+      for (std::size_t i = 0; i + 1 < n; ++i)
+        workers.emplace_back(work, i * blocks / n, (i + 1) * blocks / n);
+      work((n - 1) * blocks / n, blocks);
+    } // join
+    _prefix[0] = Crc{}.value();
+    for (std::size_t k = 0; k != blocks; ++k)
+      _prefix[k+1] = Crc::Combine(_prefix[k], _prefix[k+1], blockSize);
+  } // ctor
+
+  std::size_t blockSize() const noexcept { return _blockSize; }
+  std::span<const std::byte> data() const noexcept { return _data; }
+
+  /// CRC of the bytes in [first, last).
+  [[nodiscard]]
+  value_type crc(std::uint64_t first, std::uint64_t last) const {
+    if (first > last || last > _data.size())
+      throw std::out_of_range{"CrcIndex: bad range"};
+    auto len = last - first;
+    if (first / _blockSize == last / _blockSize)
+      return Crc{}(_data.subspan(first, len)).value();
+    // CRC(A) and CRC(AB) determine CRC(B): CRC(AB) = Combine(A, B, |B|),
+    // and Combine() is linear in its second argument.
+    return prefix(last) ^ Crc::Combine(prefix(first), 0, len);
+  } // crc
+
+  /// CRC of the whole buffer.
+  [[nodiscard]]
+  value_type crc() const { return prefix(_data.size()); }
+}; // CrcIndex
+
+} // tjg::crc
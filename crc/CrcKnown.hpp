@@ -5,8 +5,12 @@
 #include "tjg/Integer.hpp"
 #include "boost/mp11/algorithm.hpp"
 
+#include <array>
+#include <span>
 #include <concepts>
 #include <utility>
+#include <cstdint>
+#include <cstddef>
 
 namespace tjg::crc {
 
@@ -37,17 +41,111 @@ struct Known
   using Base::reset;
   using Base::update;
   using Base::updateBit;
+  using Base::updateZeros;
+  using Base::patch;
 
-  /// Extends Crc::value() to reflect the output if ReflectIn != ReflectOut.
-  [[nodiscard]]
-  constexpr value_type value() const noexcept {
+protected:
+  /// Reflects `v` if ReflectIn != ReflectOut.  This is its own inverse.
+  static constexpr value_type Output(value_type v) noexcept {
     if constexpr (Traits::ReflectIn == Traits::ReflectOut) {
-      return Base::value();
+      return v;
     } else {
       constexpr auto Shift = 8 * sizeof(value_type) - Traits::Bits;
-      return IntMath::Reflect(Base::value()) >> Shift;
+      return static_cast<value_type>(IntMath::Reflect(v) >> Shift);
+    }
+  } // Output
+
+public:
+  /// Extends Crc::value() to reflect the output if ReflectIn != ReflectOut.
+  [[nodiscard]]
+  constexpr value_type value() const noexcept { return Output(Base::value()); }
+
+  /// Extends Crc::combine() to reflect if ReflectIn != ReflectOut.
+  [[nodiscard]]
+  constexpr value_type combine(value_type crcA, value_type crcB,
+                               std::uint64_t lenB) const noexcept
+  { return Output(Base::combine(Output(crcA), Output(crcB), lenB)); }
+
+  /// Extends Crc::append() to reflect if ReflectIn != ReflectOut.
+  constexpr void append(value_type crcB, std::uint64_t lenB) noexcept
+    { Base::append(Output(crcB), lenB); }
+
+  /// Extends Crc::restore() to reflect if ReflectIn != ReflectOut.
+  constexpr void restore(value_type crc) noexcept
+    { Base::restore(Output(crc)); }
+
+  /// CRC of A followed by B, given crcA = CRC(A), crcB = CRC(B), and
+  /// the length of B in bytes.  Init and XorOut are specified by Traits_.
+  [[nodiscard]]
+  static constexpr value_type Combine(value_type crcA, value_type crcB,
+                                      std::uint64_t lenB) noexcept
+  { return Known{}.combine(crcA, crcB, lenB); }
+
+  /// New CRC of a `length`-byte message whose CRC was `crc`, after the
+  /// bytes at `offset` change from `oldBytes` to `newBytes`.
+  /// @see Crc::patch()
+  [[nodiscard]]
+  static constexpr value_type Patch(value_type crc, std::uint64_t length,
+                                    std::uint64_t offset,
+                                    std::span<const std::byte> oldBytes,
+                                    std::span<const std::byte> newBytes)
+  {
+    auto k = Known{};
+    k.reg(k.Register(Output(crc)));
+    k.patch(length, offset, oldBytes, newBytes);
+    return k.value();
+  } // Patch
+
+  /// Size of a CRC trailer in bytes.
+  static constexpr std::size_t TrailerSize = (Bits + 7) / 8;
+
+  /// Serializes `crc` in transmission order, to follow the payload.
+  /// Reflected CRCs are little-endian, others are big-endian.  If Bits is
+  /// not a multiple of 8, the partial byte (the last for reflected CRCs,
+  /// the first for others) holds the CRC bits in its low-order bits.
+  static constexpr auto Trailer(value_type crc) noexcept {
+    auto trailer = std::array<std::byte, TrailerSize>{};
+    auto v = static_cast<std::uint64_t>(Output(crc));
+    for (std::size_t i = 0; i != TrailerSize; ++i) {
+      auto b = static_cast<std::byte>(v >> (8 * i));
+      if constexpr (Dir == Endian::LsbFirst)
+        trailer[i] = b;
+      else
+        trailer[TrailerSize - 1 - i] = b;
+    }
+    return trailer;
+  } // Trailer
+
+  /// Syndrome of a frame, a payload followed by its Trailer(), computed in
+  /// one pass: the frame's residue (before XorOut) xor Traits::Residue.  It
+  /// is zero for an intact frame and depends only on the error pattern.
+  /// The frame must hold at least TrailerSize bytes.
+  [[nodiscard]]
+  static constexpr value_type Syndrome(std::span<const std::byte> frame)
+                                       noexcept
+  {
+    constexpr auto Partial = Bits % 8;
+    auto k = Known{};
+    if constexpr (Partial == 0) {
+      k.update(frame);
+    } else if constexpr (Dir == Endian::LsbFirst) {
+      k.update(frame.first(frame.size() - 1));
+      k.update(frame.back(), Partial);
+    } else {
+      auto payload = frame.size() - TrailerSize;
+      k.update(frame.first(payload));
+      k.update(frame[payload] << (8 - Partial), Partial);
+      k.update(frame.subspan(payload + 1));
     }
-  }
+    return static_cast<value_type>(k.value() ^ Traits::XorOut
+                                   ^ Traits::Residue);
+  } // Syndrome
+
+  /// Verifies a frame, a payload followed by its Trailer(), in one pass:
+  /// the CRC of an intact frame is always Traits::Residue (before XorOut).
+  [[nodiscard]]
+  static constexpr bool Verify(std::span<const std::byte> frame) noexcept
+    { return frame.size() >= TrailerSize && Syndrome(frame) == 0; }
 
   constexpr operator value_type() const noexcept { return value(); }
 
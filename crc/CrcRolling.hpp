@@ -0,0 +1,103 @@
+#pragma once
+
+#include "crc/CrcKnown.hpp"
+
+#include <array>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace tjg::crc {
+
+/// CRC over a sliding window of the most recent Window_ bytes.  Each slide
+/// costs two table lookups: one adds the incoming byte, the other removes
+/// the byte that leaves the window.  Once the window is full, value() equals
+/// Known<Traits_> computed over the window contents.
+template<class Traits_, std::size_t Window_>
+requires (Window_ > 0)
+class RollingCrc: private Known<Traits_, 1> {
+private:
+  using Base = Known<Traits_, 1>;
+
+public:
+  using Traits = Traits_;
+  using value_type = Base::value_type;
+
+  static constexpr auto Window = Window_;
+  static constexpr auto Bits   = Traits::Bits;
+  static constexpr auto Dir    = Base::Dir;
+  static constexpr auto Name   = Traits::Name;
+
+private:
+  using Table = std::array<value_type, 256>;
+
+  /// Table[b] removes byte b from the front of a window that has just had
+  /// a byte appended: x^(8*Window) * b, plus the correction that keeps the
+  /// initial value's contribution at x^(8*Window).
+  static consteval Table Generate() noexcept {
+    using detail::ShiftZeros;
+    using detail::Compute;
+    static constexpr auto Poly = Base::FastPoly;
+    auto init = Base::Init(Traits::Init);
+    auto fix  = ShiftZeros<Poly, Dir, Bits>(init, Window + 1)
+              ^ ShiftZeros<Poly, Dir, Bits>(init, Window);
+    auto table = Table{};
+    for (unsigned b = 0; b != 256; ++b) {
+      auto crc = Compute<Poly, Dir, 1>(value_type{0}, std::byte(b));
+      table[b] = ShiftZeros<Poly, Dir, Bits>(crc, Window) ^ fix;
+    }
+    return table;
+  } // Generate
+
+  static constexpr Table OutTable = Generate();
+
+  std::array<std::byte, Window> _window{};
+  std::size_t _pos = 0;
+  bool _full = false;
+
+public:
+  constexpr RollingCrc() noexcept : Base{} { }
+
+  constexpr void reset() noexcept {
+    Base::reset();
+    _pos  = 0;
+    _full = false;
+  }
+
+  /// Has the window been filled?
+  constexpr bool full() const noexcept { return _full; }
+
+  /// Slide without the internal window: remove `out`, which must be the byte
+  /// that entered Window bytes before `in`, and add `in`.
+  constexpr void roll(std::byte out, std::byte in) noexcept {
+    auto crc = detail::Compute<Base::FastPoly, Dir, 1>(Base::reg(), in);
+    Base::reg(crc ^ OutTable[std::to_integer<std::uint8_t>(out)]);
+  }
+
+  /// Append `in`, removing the oldest byte once the window is full.
+  constexpr void update(std::byte in) noexcept {
+    if (_full)
+      roll(_window[_pos], in);
+    else
+      Base::update(in);
+    _window[_pos] = in;
+    if (++_pos == Window) {
+      _pos  = 0;
+      _full = true;
+    }
+  } // update
+
+  constexpr void update(std::span<const std::byte> buf) noexcept {
+    for (auto b: buf)
+      update(b);
+  }
+
+  using Base::value;
+
+  constexpr operator value_type() const noexcept { return value(); }
+
+  constexpr RollingCrc& operator()(std::byte b) noexcept
+    { update(b); return *this; }
+}; // RollingCrc
+
+} // tjg::crc
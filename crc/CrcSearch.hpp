@@ -0,0 +1,406 @@
+#pragma once
+
+#include "crc/CrcParallel.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include "tjg/Gf2Poly.hpp"
+#include "tjg/Reflect.hpp"
+
+#include "boost/mp11/algorithm.hpp"
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <array>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+namespace tjg::crc {
+
+/// CRC parameters in the Rocksoft model used by the catalogue: the
+/// register starts at `init`, input bytes are reflected if `reflectIn`,
+/// and the final register is reflected if `reflectOut`, then xored with
+/// `xorOut`.  Values are in normal (unreflected) form.
+///
+/// If x+1 divides the generator, a second (init, xorOut) pair yields the
+/// same CRC for every message; searches report one of them.
+struct CrcModel {
+  std::size_t bits = 0;
+  std::uint64_t poly = 0;
+  std::uint64_t init = 0;
+  bool reflectIn = false;
+  bool reflectOut = false;
+  std::uint64_t xorOut = 0;
+  std::string_view name{};  ///< Catalogue name; empty if not catalogued.
+  bool unique = true;       ///< Did the samples determine the CRC?
+}; // CrcModel
+
+/// A message and its CRC.
+struct CrcSample {
+  std::span<const std::byte> message;
+  std::uint64_t crc;
+}; // CrcSample
+
+namespace detail {
+
+/// Bitwise CRC with run-time parameters; slow, but any poly will do.
+class ModelCrc {
+  std::uint64_t _poly;
+  std::uint64_t _mask;
+  unsigned _bits;
+
+public:
+  ModelCrc(std::size_t bits, std::uint64_t poly) noexcept
+    : _poly{poly}, _mask{~std::uint64_t{0} >> (64 - bits)}
+    , _bits{static_cast<unsigned>(bits)} { }
+
+  std::uint64_t poly() const noexcept { return _poly; }
+  std::uint64_t mask() const noexcept { return _mask; }
+
+  /// Reflects the low `bits` bits of `v`.
+  std::uint64_t reflect(std::uint64_t v) const noexcept
+    { return IntMath::Reflect(v) >> (64 - _bits); }
+
+  /// r * x mod P.
+  std::uint64_t mulX(std::uint64_t r) const noexcept {
+    auto top = (r >> (_bits - 1)) & 1;
+    return ((r << 1) & _mask) ^ (_poly & (0 - top));
+  }
+
+  /// Register `r` updated with `buf`, in normal form.
+  template<bool ReflectIn>
+  std::uint64_t update(std::uint64_t r, std::span<const std::byte> buf)
+                       const noexcept
+  {
+    for (auto b: buf) {
+      auto v = std::to_integer<unsigned>(ReflectIn ? IntMath::Reflect(b) : b);
+      for (int i = 7; i >= 0; --i) {
+        auto top = ((r >> (_bits - 1)) ^ (v >> i)) & 1;
+        r = ((r << 1) & _mask) ^ (_poly & (0 - top));
+      }
+    }
+    return r;
+  } // update
+
+  std::uint64_t update(bool reflectIn, std::uint64_t r,
+                       std::span<const std::byte> buf) const noexcept
+    { return reflectIn ? update<true>(r, buf) : update<false>(r, buf); }
+
+  /// x^n mod P.
+  std::uint64_t powX(std::uint64_t n) const noexcept
+    { return IntMath::XPowMod(n, _poly, static_cast<int>(_bits)); }
+}; // ModelCrc
+
+/// Polynomial over GF(2) of arbitrary degree; bit i is the coefficient of
+/// x^i.
+class Gf2Poly {
+  std::vector<std::uint64_t> _words;
+
+  void trim() noexcept {
+    while (!_words.empty() && _words.back() == 0)
+      _words.pop_back();
+  }
+
+public:
+  Gf2Poly() = default;
+
+  /// d(x) x^bits + c(x), where d is the message's bit stream, with bytes
+  /// reflected if `reflectIn`, and its first bit the highest power.
+  static Gf2Poly FromMessage(std::span<const std::byte> msg, bool reflectIn,
+                             std::size_t bits, std::uint64_t c)
+  {
+    auto p = Gf2Poly{};
+    p._words.assign((8 * msg.size() + bits) / 64 + 2, 0);
+    p._words[0] = c;
+    for (std::size_t i = 0; i != msg.size(); ++i) {
+      auto b = reflectIn ? IntMath::Reflect(msg[i]) : msg[i];
+      auto v = std::uint64_t{std::to_integer<std::uint8_t>(b)};
+      auto e = bits + 8 * (msg.size() - 1 - i);
+      p._words[e / 64] ^= v << (e % 64);
+      if (e % 64 > 56)
+        p._words[e / 64 + 1] ^= v >> (64 - e % 64);
+    }
+    p.trim();
+    return p;
+  } // FromMessage
+
+  /// Degree, or -1 for the zero polynomial.
+  int degree() const noexcept {
+    if (_words.empty())
+      return -1;
+    return static_cast<int>(64 * _words.size()) - 1
+         - std::countl_zero(_words.back());
+  }
+
+  bool coefficient(std::size_t i) const noexcept
+    { return i / 64 < _words.size() && ((_words[i / 64] >> (i % 64)) & 1); }
+
+  /// Coefficients of x^0 to x^63.
+  std::uint64_t low() const noexcept
+    { return _words.empty() ? 0 : _words[0]; }
+
+  /// This mod x^bits + poly.
+  std::uint64_t mod(std::uint64_t poly, std::size_t bits) const noexcept {
+    auto mask = ~std::uint64_t{0} >> (64 - bits);
+    auto r = std::uint64_t{0};
+    for (auto i = degree(); i >= 0; --i) {
+      auto top = (r >> (bits - 1)) & 1;
+      r = ((r << 1) & mask) | coefficient(static_cast<std::size_t>(i));
+      r ^= poly & (0 - top);
+    }
+    return r;
+  } // mod
+
+  /// This mod b.
+  void reduce(const Gf2Poly& b) noexcept {
+    auto db = b.degree();
+    for (auto da = degree(); da >= db; da = degree()) {
+      // this ^= b * x^(da - db)
+      auto shift = static_cast<std::size_t>(da - db);
+      auto words = shift / 64;
+      auto bitsh = shift % 64;
+      for (std::size_t i = 0; i != b._words.size(); ++i) {
+        _words[i + words] ^= b._words[i] << bitsh;
+        if (bitsh != 0 && i + words + 1 < _words.size())
+          _words[i + words + 1] ^= b._words[i] >> (64 - bitsh);
+      }
+      trim();
+    }
+  } // reduce
+
+  friend Gf2Poly Gcd(Gf2Poly a, Gf2Poly b) {
+    while (b.degree() >= 0) {
+      a.reduce(b);
+      std::swap(a, b);
+    }
+    return a;
+  } // Gcd
+}; // Gf2Poly
+
+/// Solves for init and xorOut, given the poly and reflection, by Gaussian
+/// elimination over GF(2).  Each sample contributes `bits` equations in the
+/// 2*bits unknowns: u = x^n * init + X + c, where u is the CRC before
+/// output reflection, n is the message length in bits, X is xorOut before
+/// output reflection, and c is the CRC of the message from a zero register.
+inline bool SolveInitXor(const ModelCrc& m, std::span<const CrcSample> samples,
+                         bool reflectIn, bool reflectOut, CrcModel& model)
+{
+  struct Row {
+    std::array<std::uint64_t, 2> coef;  ///< [0]: init, [1]: X.
+    bool rhs;
+  }; // Row
+  auto bits = model.bits;
+  auto rows = std::vector<Row>{};
+  rows.reserve(bits * samples.size());
+  for (auto& s: samples) {
+    auto u = reflectOut ? m.reflect(s.crc & m.mask()) : (s.crc & m.mask());
+    auto c = m.update(reflectIn, 0, s.message);
+    // Column j of the x^n multiplication matrix is x^(n+j) mod P.
+    auto cols = std::array<std::uint64_t, 64>{};
+    cols[0] = m.powX(8 * std::uint64_t{s.message.size()});
+    for (std::size_t j = 1; j < bits; ++j)
+      cols[j] = m.mulX(cols[j-1]);
+    for (std::size_t i = 0; i != bits; ++i) {
+      auto row = Row{{0, std::uint64_t{1} << i}, bool(((u ^ c) >> i) & 1)};
+      for (std::size_t j = 0; j != bits; ++j)
+        row.coef[0] |= ((cols[j] >> i) & 1) << j;
+      rows.push_back(row);
+    }
+  }
+  auto pivots = std::vector<std::size_t>{};
+  auto rank = std::size_t{0};
+  for (std::size_t col = 0; col != 2 * bits && rank != rows.size(); ++col) {
+    auto w = col / bits;
+    auto bit = std::uint64_t{1} << (col % bits);
+    auto p = std::find_if(rows.begin() + rank, rows.end(),
+                          [&](const Row& r) { return r.coef[w] & bit; });
+    if (p == rows.end())
+      continue;
+    std::swap(*p, rows[rank]);
+    for (std::size_t r = 0; r != rows.size(); ++r) {
+      if (r != rank && (rows[r].coef[w] & bit)) {
+        rows[r].coef[0] ^= rows[rank].coef[0];
+        rows[r].coef[1] ^= rows[rank].coef[1];
+        rows[r].rhs     ^= rows[rank].rhs;
+      }
+    }
+    pivots.push_back(col);
+    ++rank;
+  }
+  for (auto r = rank; r != rows.size(); ++r) {
+    if (rows[r].rhs)
+      return false;
+  }
+  // Free unknowns are taken as zero.
+  auto solution = std::array<std::uint64_t, 2>{};
+  for (std::size_t r = 0; r != rank; ++r) {
+    if (rows[r].rhs)
+      solution[pivots[r] / bits] |= std::uint64_t{1} << (pivots[r] % bits);
+  }
+  model.init = solution[0];
+  model.xorOut = reflectOut ? m.reflect(solution[1]) : solution[1];
+  model.reflectIn = reflectIn;
+  model.reflectOut = reflectOut;
+  // The unknowns always have a null space if x+1 divides the generator:
+  // init + P/(x+1) and a matching xorOut give the same CRCs.
+  auto parity = std::popcount(m.poly()) % 2 == 1;
+  model.unique = (rank + parity == 2 * bits);
+  return true;
+} // SolveInitXor
+
+} // detail
+
+/// CRC of `message` under `model`.
+inline std::uint64_t ModelCrc(const CrcModel& model,
+                              std::span<const std::byte> message)
+{
+  auto m = detail::ModelCrc{model.bits, model.poly};
+  auto r = m.update(model.reflectIn, model.init & m.mask(), message);
+  return (model.reflectOut ? m.reflect(r) : r) ^ model.xorOut;
+} // ModelCrc
+
+/// Catalogued CRCs that match every sample, computed with the fast kernels.
+inline std::vector<CrcModel> FindKnownCrcs(std::span<const CrcSample> samples)
+{
+  auto found = std::vector<CrcModel>{};
+  boost::mp11::mp_for_each<test_detail::KnownCrcs>([&](auto I) {
+    using Traits = decltype(I);
+    using Crc = Known<Traits, MaxSlices>;
+    auto match = std::ranges::all_of(samples, [](const CrcSample& s) {
+      return Crc{}(s.message).value() == s.crc;
+    });
+    if (match) {
+      found.push_back(CrcModel{Traits::Bits, Traits::Poly, Traits::Init,
+                               Traits::ReflectIn, Traits::ReflectOut,
+                               Traits::XorOut, Traits::Name});
+    }
+  });
+  return found;
+} // FindKnownCrcs
+
+/// Models of width `bits` that match every sample, using up to `threads`
+/// threads (0 means one per hardware thread).  Stops after `maxResults`.
+///
+/// The difference d of two samples of equal length depends on neither init
+/// nor xorOut: its CRC from a zero register is d(x) x^bits mod P, so P
+/// divides d(x) x^bits + (crc1 ^ crc2).  The gcd of these polynomials over
+/// all such pairs is usually P itself; otherwise every poly is tried
+/// against it in parallel.  Each surviving poly is then solved for init and
+/// xorOut.  Give at least three samples of one length and two of others.
+/// Without equal-length pairs, every poly is solved for, which is slow.
+inline std::vector<CrcModel> SearchCrcs(std::span<const CrcSample> samples,
+                                        std::size_t bits,
+                                        unsigned threads = 0,
+                                        std::size_t maxResults = 100)
+{
+  using detail::Gf2Poly;
+  if (bits < 1 || bits > 64)
+    throw std::invalid_argument{"SearchCrcs: width must be 1 to 64"};
+  if (samples.empty())
+    throw std::invalid_argument{"SearchCrcs: no samples"};
+  auto mask = ~std::uint64_t{0} >> (64 - bits);
+  auto reflect = [&](std::uint64_t v) {
+    return IntMath::Reflect(v) >> (64 - bits);
+  };
+
+  // Differences of each sample with the previous one of the same length.
+  struct Diff {
+    std::vector<std::byte> message;
+    std::uint64_t crc;
+  }; // Diff
+  auto diffs = std::vector<Diff>{};
+  for (std::size_t i = 0; i != samples.size(); ++i) {
+    for (auto j = i; j-- != 0; ) {
+      auto& a = samples[i];
+      auto& b = samples[j];
+      if (a.message.size() != b.message.size())
+        continue;
+      auto d = Diff{std::vector<std::byte>(a.message.size()),
+                    (a.crc ^ b.crc) & mask};
+      for (std::size_t k = 0; k != d.message.size(); ++k)
+        d.message[k] = a.message[k] ^ b.message[k];
+      diffs.push_back(std::move(d));
+      break;
+    }
+  }
+
+  // For each reflection: the gcd, and whether every poly must be tried.
+  struct Variant {
+    bool reflectIn;
+    bool reflectOut;
+    Gf2Poly gcd;
+    bool search;
+  }; // Variant
+  auto variants = std::vector<Variant>{};
+  auto found = std::vector<CrcModel>{};
+  auto lock = std::mutex{};
+  auto done = std::atomic<bool>{false};
+  auto solve = [&](std::uint64_t poly, const Variant& v) {
+    auto m = detail::ModelCrc{bits, poly};
+    auto model = CrcModel{bits, poly};
+    if (!detail::SolveInitXor(m, samples, v.reflectIn, v.reflectOut, model))
+      return;
+    auto guard = std::scoped_lock{lock};
+    found.push_back(model);
+    if (found.size() >= maxResults)
+      done = true;
+  };
+  for (bool refIn: {false, true}) {
+    for (bool refOut: {false, true}) {
+      auto v = Variant{refIn, refOut, Gf2Poly{}, diffs.empty()};
+      for (auto& d: diffs) {
+        auto c = refOut ? reflect(d.crc) : d.crc;
+        v.gcd = Gcd(std::move(v.gcd),
+                    Gf2Poly::FromMessage(d.message, refIn, bits, c));
+      }
+      auto degree = v.gcd.degree();
+      if (!v.search && degree < 0) {
+        v.search = true;    // No information: all differences were zero.
+      } else if (!v.search && degree == static_cast<int>(bits)) {
+        if (v.gcd.coefficient(0))
+          solve(v.gcd.low() & mask, v);
+        continue;
+      } else if (!v.search && degree < static_cast<int>(bits)) {
+        continue;
+      }
+      variants.push_back(std::move(v));
+    }
+  }
+
+  if (!variants.empty() && !done) {
+    auto polys = std::uint64_t{1} << (bits - 1);    // Odd polys only.
+    auto nt = static_cast<unsigned>(std::min<std::uint64_t>(
+                                      detail::NumThreads(threads), polys));
+    auto work = [&](unsigned t) {
+      for (auto k = std::uint64_t{t}; k < polys && !done; k += nt) {
+        auto poly = 2 * k + 1;
+        for (auto& v: variants) {
+          if (v.gcd.degree() < 0 || v.gcd.mod(poly, bits) == 0)
+            solve(poly, v);
+        }
+      }
+    };
+    auto workers = std::vector<std::jthread>{};
+    workers.reserve(nt - 1);
+    for (unsigned t = 0; t + 1 < nt; ++t)
+      workers.emplace_back(work, t);
+    work(nt - 1);
+  } // join
+
+  std::ranges::sort(found, {}, [](const CrcModel& m) {
+    return std::tuple{m.poly, m.reflectIn, m.reflectOut};
+  });
+  if (found.size() > maxResults)
+    found.resize(maxResults);
+  return found;
+} // SearchCrcs
+
+} // tjg::crc
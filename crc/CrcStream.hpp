@@ -0,0 +1,164 @@
+#pragma once
+
+#include "crc/Crc.hpp"
+
+#include <streambuf>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+namespace tjg::crc {
+
+/// Output filter: checksums every byte written, then forwards it to a sink
+/// streambuf.  Bytes are checksummed in bulk, when the put area is flushed
+/// or when crc() is called.  A null sink discards the data.
+template<detail::CrcLike C>
+class CrcOStreamBuf: public std::streambuf {
+private:
+  std::streambuf* _sink;
+  C _crc;
+  std::vector<char> _buf;
+  char* _mark;  ///< Bytes in [pbase(), _mark) are already checksummed.
+
+  void account() {
+    _crc.update(std::as_bytes(std::span{_mark, pptr()}));
+    _mark = pptr();
+  }
+
+  bool flushBuf() {
+    account();
+    auto n = std::streamsize{pptr() - pbase()};
+    if (n != 0 && _sink && _sink->sputn(pbase(), n) != n)
+      return false;
+    setp(_buf.data(), _buf.data() + _buf.size());
+    _mark = pbase();
+    return true;
+  } // flushBuf
+
+protected:
+  int_type overflow(int_type ch) override {
+    if (!flushBuf())
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  } // overflow
+
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    if (n < epptr() - pptr()) {
+      std::ranges::copy_n(s, n, pptr());
+      pbump(static_cast<int>(n));
+      return n;
+    }
+    if (!flushBuf())
+      return 0;
+    auto put = _sink ? _sink->sputn(s, n) : n;
+    _crc.update(std::as_bytes(std::span{s, static_cast<std::size_t>(put)}));
+    return put;
+  } // xsputn
+
+  int sync() override {
+    if (!flushBuf())
+      return -1;
+    return _sink ? _sink->pubsync() : 0;
+  }
+
+public:
+  explicit CrcOStreamBuf(std::streambuf* sink, C crc = C{},
+                         std::size_t bufSize = std::size_t{1} << 16)
+    : _sink{sink}, _crc{std::move(crc)}, _buf(bufSize)
+  {
+    setp(_buf.data(), _buf.data() + _buf.size());
+    _mark = pbase();
+  }
+
+  CrcOStreamBuf(const CrcOStreamBuf&) = delete;
+  CrcOStreamBuf& operator=(const CrcOStreamBuf&) = delete;
+
+  ~CrcOStreamBuf() override { (void) flushBuf(); }
+
+  /// Checksum of all bytes written so far, whether or not flushed.
+  const C& crc() { account(); return _crc; }
+
+  void reset() {
+    account();
+    _crc.reset();
+  }
+}; // CrcOStreamBuf
+
+/// Input filter: reads from a source streambuf and checksums every byte as
+/// it is consumed.  Bytes are checksummed in bulk, when the get area is
+/// refilled or when crc() is called.  Putback is limited to bytes not yet
+/// checksummed.
+template<detail::CrcLike C>
+class CrcIStreamBuf: public std::streambuf {
+private:
+  std::streambuf* _source;
+  C _crc;
+  std::vector<char> _buf;
+
+  void account() {
+    _crc.update(std::as_bytes(std::span{eback(), gptr()}));
+    setg(gptr(), gptr(), egptr());
+  }
+
+protected:
+  int_type underflow() override {
+    if (gptr() < egptr())
+      return traits_type::to_int_type(*gptr());
+    account();
+    auto n = _source->sgetn(_buf.data(), std::ssize(_buf));
+    if (n <= 0)
+      return traits_type::eof();
+    setg(_buf.data(), _buf.data(), _buf.data() + n);
+    return traits_type::to_int_type(*gptr());
+  } // underflow
+
+  std::streamsize xsgetn(char* s, std::streamsize n) override {
+    auto got = std::streamsize{0};
+    for (;;) {
+      auto num = std::min(n - got, std::streamsize{egptr() - gptr()});
+      std::ranges::copy_n(gptr(), num, s + got);
+      gbump(static_cast<int>(num));
+      got += num;
+      if (got == n)
+        return got;
+      if (n - got < std::ssize(_buf)) {
+        if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+          return got;
+        continue;
+      }
+      // Large reads bypass the buffer.
+      account();
+      auto more = _source->sgetn(s + got, n - got);
+      if (more <= 0)
+        return got;
+      _crc.update(std::as_bytes(std::span{s + got,
+                                          static_cast<std::size_t>(more)}));
+      return got + more;
+    }
+  } // xsgetn
+
+public:
+  explicit CrcIStreamBuf(std::streambuf* source, C crc = C{},
+                         std::size_t bufSize = std::size_t{1} << 16)
+    : _source{source}, _crc{std::move(crc)}, _buf(bufSize)
+  { setg(_buf.data(), _buf.data(), _buf.data()); }
+
+  CrcIStreamBuf(const CrcIStreamBuf&) = delete;
+  CrcIStreamBuf& operator=(const CrcIStreamBuf&) = delete;
+
+  /// Checksum of all bytes consumed so far.
+  const C& crc() { account(); return _crc; }
+
+  void reset() {
+    account();
+    _crc.reset();
+  }
+}; // CrcIStreamBuf
+
+} // tjg::crc
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "crc/Crc.hpp"
+
+#include <ranges>
+#include <iterator>
+#include <memory>
+#include <bit>
+#include <utility>
+#include <cstddef>
+
+namespace tjg::crc {
+
+template<class C>
+concept ByteUpdatable = requires(C& c, std::byte b) { c.update(b); };
+
+/// Pass-through view that updates a CRC with each element as the consumer
+/// advances past it.  Elements that are dereferenced but never stepped over
+/// are not included.
+template<std::ranges::input_range V, ByteUpdatable C>
+requires std::ranges::view<V> && TrivialByte<std::ranges::range_value_t<V>>
+class CrcView: public std::ranges::view_interface<CrcView<V, C>> {
+private:
+  V  _base = V{};
+  C* _crc  = nullptr;
+
+  class Iterator {
+  private:
+    std::ranges::iterator_t<V> _cur = std::ranges::iterator_t<V>{};
+    C* _crc = nullptr;
+
+  public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type       = std::ranges::range_value_t<V>;
+    using difference_type  = std::ranges::range_difference_t<V>;
+
+    Iterator() = default;
+    constexpr Iterator(std::ranges::iterator_t<V> cur, C* crc)
+      : _cur{std::move(cur)}, _crc{crc} { }
+
+    constexpr const auto& base() const& noexcept { return _cur; }
+
+    constexpr decltype(auto) operator*() const { return *_cur; }
+
+    constexpr Iterator& operator++() {
+      _crc->update(std::bit_cast<std::byte>(value_type(*_cur)));
+      ++_cur;
+      return *this;
+    }
+
+    constexpr void operator++(int) { ++*this; }
+  }; // Iterator
+
+  class Sentinel {
+  private:
+    std::ranges::sentinel_t<V> _end = std::ranges::sentinel_t<V>{};
+
+  public:
+    Sentinel() = default;
+    constexpr explicit Sentinel(std::ranges::sentinel_t<V> end)
+      : _end{std::move(end)} { }
+
+    friend constexpr bool operator==(const Iterator& i, const Sentinel& s)
+      { return i.base() == s._end; }
+  }; // Sentinel
+
+public:
+  CrcView() requires std::default_initializable<V> = default;
+
+  constexpr CrcView(V base, C& crc)
+    : _base{std::move(base)}, _crc{std::addressof(crc)} { }
+
+  constexpr V base() const& requires std::copy_constructible<V>
+    { return _base; }
+  constexpr V base() && { return std::move(_base); }
+
+  constexpr Iterator begin()
+    { return Iterator{std::ranges::begin(_base), _crc}; }
+
+  constexpr Sentinel end() { return Sentinel{std::ranges::end(_base)}; }
+
+  constexpr auto size() requires std::ranges::sized_range<V>
+    { return std::ranges::size(_base); }
+}; // CrcView
+
+template<class R, class C>
+CrcView(R&&, C&) -> CrcView<std::views::all_t<R>, C>;
+
+namespace views {
+
+/// @internal
+namespace detail {
+
+template<class C>
+struct CrcClosure {
+  C* crc;
+
+  template<std::ranges::viewable_range R>
+  friend constexpr auto operator|(R&& r, CrcClosure c)
+    { return CrcView{std::views::all(std::forward<R>(r)), *c.crc}; }
+}; // CrcClosure
+
+struct CrcFn {
+  template<std::ranges::viewable_range R, ByteUpdatable C>
+  constexpr auto operator()(R&& r, C& c) const
+    { return CrcView{std::views::all(std::forward<R>(r)), c}; }
+
+  template<ByteUpdatable C>
+  constexpr auto operator()(C& c) const
+    { return CrcClosure<C>{std::addressof(c)}; }
+}; // CrcFn
+
+} // detail
+
+/// Range adaptor: `for (auto b: data | views::crc(myCrc)) ...` updates
+/// `myCrc` with every byte the loop consumes.
+inline constexpr detail::CrcFn crc{};
+
+} // views
+
+} // tjg::crc
@@ -0,0 +1,164 @@
+#include "crc/CrcBufferPool.hpp"
+#include "crc/CrcFile.hpp"
+#include "crc/CrcKnown.hpp"
+#include "test/TestCheck.hpp"
+
+#include <memory_resource>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <new>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+using namespace tjg::test;
+
+namespace {
+
+/// Calls of the global operator new, replaced below.
+int newCount = 0;
+
+} // anonymous
+
+void* operator new(std::size_t size) {
+  ++newCount;
+  if (auto p = std::malloc(std::max<std::size_t>(size, 1)))
+    return p;
+  throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+  ++newCount;
+  auto a = static_cast<std::size_t>(align);
+  if (auto p = std::aligned_alloc(a, std::max((size + a - 1) / a * a, a)))
+    return p;
+  throw std::bad_alloc{};
+}
+
+// Not inlined, lest GCC pair the free() with operator new and warn.
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete(void* p, std::align_val_t) noexcept
+  { operator delete(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+  { operator delete(p); }
+
+namespace {
+
+/// Counts what reaches the upstream resource.
+class Counting: public std::pmr::memory_resource {
+public:
+  int allocs = 0;
+  int frees  = 0;
+private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    ++allocs;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+  {
+    ++frees;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+                   noexcept override
+    { return this == &other; }
+}; // Counting
+
+bool TestReuse() {
+  auto upstream = Counting{};
+  auto pool = tjg::crc::BufferPool{10000, false, &upstream};
+  auto ok = (pool.bufferSize() == 12288 && pool.idle() == 0);
+  auto a = pool.allocate(pool.bufferSize(), 4096);
+  auto b = pool.allocate(100);
+  ok &= (reinterpret_cast<std::uintptr_t>(a) % 4096 == 0);
+  pool.deallocate(a, pool.bufferSize(), 4096);
+  pool.deallocate(b, 100);
+  ok &= (pool.idle() == 2);
+  auto c = pool.allocate(5000, 64);
+  ok &= (c == a || c == b) && pool.idle() == 1;
+  pool.deallocate(c, 5000, 64);
+  // Too large, or too strictly aligned, for a pooled buffer.
+  auto d = pool.allocate(pool.bufferSize() + 1);
+  auto e = pool.allocate(16, 8192);
+  pool.deallocate(d, pool.bufferSize() + 1);
+  pool.deallocate(e, 16, 8192);
+  return ok && upstream.allocs == 2 && upstream.frees == 2;
+} // TestReuse
+
+bool TestHugePages() {
+  auto pool = tjg::crc::BufferPool{1, true};
+  auto p = pool.allocate(1);
+  auto ok = (reinterpret_cast<std::uintptr_t>(p) % pool.HugePageSize == 0)
+         && pool.bufferSize() == pool.HugePageSize;
+  pool.deallocate(p, 1);
+  return ok;
+} // TestHugePages
+
+bool TestPmrContainer() {
+  auto pool = tjg::crc::BufferPool{1<<16};
+  auto v = std::pmr::vector<std::byte>{&pool};
+  v.resize(1000);
+  v.resize(2000);
+  auto ok = (v.size() == 2000);
+  v = std::pmr::vector<std::byte>{&pool};
+  return ok && pool.idle() >= 1;
+} // TestPmrContainer
+
+bool TestFileCrc() {
+  namespace fs = std::filesystem;
+  using namespace tjg::crc;
+  auto name = fs::temp_directory_path() / "CrcBufferPool.tmp";
+  {
+    auto out = std::ofstream{name, std::ios::binary};
+    for (int i = 0; i != 100000; ++i)
+      out.put(static_cast<char>(i * 7));
+  }
+  auto pool = BufferPool{};
+  auto ok = true;
+  for (int i = 0; i != 10; ++i) {
+    ok &= (FileCrc(name, pool) == FileCrc(name));
+    ok &= (FileCksum(name, pool) == FileCksum(name));
+    ok &= (FileCrc(name, Known<Crc64Xz, 8>{}, pool, 4096)
+           == FileCrc(name, Known<Crc64Xz, 8>{}));
+  }
+  // One buffer served every call.
+  ok &= (pool.idle() == 1);
+  // Nor does anything else allocate, whatever the form of the name.
+  auto crc = FileCrc(name).value();
+  auto cksum = FileCksum(name).value();
+  auto str = name.string();
+  auto before = newCount;
+  for (int i = 0; i != 10; ++i) {
+    ok &= (FileCrc(name, pool) == crc && FileCksum(name, pool) == cksum);
+    ok &= (FileCrc(str, pool) == crc && FileCksum(str, pool) == cksum);
+    ok &= (FileCrc(str.c_str(), pool) == crc);
+  }
+  ok &= (newCount == before);
+  if (newCount != before)
+    std::cout << "  " << (newCount - before) << " allocations" << std::endl;
+  fs::remove(name);
+  return ok;
+} // TestFileCrc
+
+} // anonymous
+
+int main() {
+  try {
+    Check(TestReuse(), "BufferPool reuse and upstream");
+    Check(TestHugePages(), "BufferPool huge pages");
+    Check(TestPmrContainer(), "BufferPool as pmr resource");
+    Check(TestFileCrc(), "FileCrc and FileCksum with BufferPool");
+  }
+  catch (std::exception& x) {
+    std::cerr << "Caught exception: " << x.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return Summary();
+} // main
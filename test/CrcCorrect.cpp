@@ -0,0 +1,148 @@
+#include "crc/CrcCorrect.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <vector>
+#include <span>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <cstddef>
+#include <cstdlib>
+
+// Builds a frame: `size` random payload bytes followed by the trailer.
+template<class Crc>
+std::vector<std::byte> Frame(std::size_t size, std::mt19937& rng) {
+  auto frame = std::vector<std::byte>(size);
+  for (auto& b: frame)
+    b = static_cast<std::byte>(rng() & 0xff);
+  auto trailer = Crc::Trailer(Crc{}(std::span{frame}).value());
+  frame.insert(frame.end(), trailer.begin(), trailer.end());
+  return frame;
+} // Frame
+
+template<class CrcTraits>
+bool TestSingle(std::size_t maxPayload, std::size_t size) {
+  using Crc = tjg::crc::Known<CrcTraits, tjg::crc::MaxSlices>;
+  std::cout << "Testing " << Crc::Name << " single, payload " << size;
+  std::mt19937 rng{size};
+  auto corrector = tjg::crc::CrcCorrector<CrcTraits>{maxPayload};
+  auto frame = Frame<Crc>(size, rng);
+  auto copy = frame;
+  if (corrector.correct(copy) != 0 || copy != frame) {
+    std::cout << " FAILED intact frame" << std::endl;
+    return false;
+  }
+  // Every bit covered by the CRC, including those of the trailer.
+  auto partial = (Crc::Bits % 8 == 0) ? 0 : 8 - Crc::Bits % 8;
+  for (std::size_t i = 0; i != frame.size(); ++i) {
+    for (unsigned bit = 0; bit != 8; ++bit) {
+      auto inTrailer = i >= size;
+      if (inTrailer && partial != 0) {
+        auto pad = (Crc::Dir == tjg::crc::Endian::LsbFirst)
+                 ? (i == frame.size() - 1) : (i == size);
+        if (pad && bit >= 8 - partial)
+          continue;
+      }
+      copy[i] ^= std::byte{1} << bit;
+      if (corrector.correct(copy) != 1 || copy != frame) {
+        std::cout << " FAILED byte " << i << " bit " << bit << std::endl;
+        return false;
+      }
+    }
+  }
+  std::cout << " PASSED" << std::endl;
+  return true;
+} // TestSingle
+
+template<class CrcTraits>
+bool TestDouble(std::size_t size) {
+  using Crc = tjg::crc::Known<CrcTraits, tjg::crc::MaxSlices>;
+  std::cout << "Testing " << Crc::Name << " double, payload " << size;
+  std::mt19937 rng{size};
+  auto corrector = tjg::crc::CrcCorrector<CrcTraits>{size};
+  auto frame = Frame<Crc>(size, rng);
+  auto pick = std::uniform_int_distribution<std::size_t>{0, 8 * size - 1};
+  for (int i = 0; i != 1000; ++i) {
+    auto a = pick(rng);
+    auto b = pick(rng);
+    if (a == b)
+      continue;
+    auto copy = frame;
+    copy[a / 8] ^= std::byte{1} << (a % 8);
+    copy[b / 8] ^= std::byte{1} << (b % 8);
+    if (corrector.correct(copy) != -1 || copy == frame) {
+      std::cout << " FAILED single-bit mode, bits "
+                << a << ", " << b << std::endl;
+      return false;
+    }
+    if (corrector.correct(copy, true) != 2 || copy != frame) {
+      std::cout << " FAILED bits " << a << ", " << b << std::endl;
+      return false;
+    }
+  }
+  std::cout << " PASSED" << std::endl;
+  return true;
+} // TestDouble
+
+// Beyond the code's capabilities, errors must be rejected or corrected to a
+// valid frame, never made worse silently.
+template<class CrcTraits>
+bool TestUncorrectable(std::size_t size) {
+  using Crc = tjg::crc::Known<CrcTraits, tjg::crc::MaxSlices>;
+  std::cout << "Testing " << Crc::Name << " uncorrectable, payload " << size;
+  std::mt19937 rng{size};
+  auto corrector = tjg::crc::CrcCorrector<CrcTraits>{size};
+  auto frame = Frame<Crc>(size, rng);
+  auto pick = std::uniform_int_distribution<std::size_t>{0, 8 * size - 1};
+  for (int i = 0; i != 200; ++i) {
+    auto copy = frame;
+    for (int k = 0; k != 3; ++k) {
+      auto a = pick(rng);
+      copy[a / 8] ^= std::byte{1} << (a % 8);
+    }
+    auto before = copy;
+    auto n = corrector.correct(copy, true);
+    if ((n < 0 && copy != before) || (n >= 0 && !Crc::Verify(copy))) {
+      std::cout << " FAILED" << std::endl;
+      return false;
+    }
+  }
+  std::cout << " PASSED" << std::endl;
+  return true;
+} // TestUncorrectable
+
+int main() {
+  using namespace tjg::crc;
+  using Crcs = boost::mp11::mp_list<Crc5Usb, Crc12Umts, Crc15Can,
+                                    Crc16Kermit, Crc16Ibm3740, Crc24Openpgp,
+                                    Crc31Philips, Crc32IsoHdlc, Crc32Mpeg2,
+                                    Crc64We, Crc64Xz>;
+
+  int failCount = 0;
+  int testCount = 0;
+  boost::mp11::mp_for_each<Crcs>([&](auto I) {
+    using Traits = decltype(I);
+    // Stay within the period of the short codes; CRC-15/CAN repeats after
+    // 127 bits.
+    auto sizes = (Traits::Bits < 8)  ? std::vector<std::size_t>{0, 1, 2}
+               : (Traits::Bits < 16) ? std::vector<std::size_t>{0, 1, 7}
+                                     : std::vector<std::size_t>{0, 1, 7, 64};
+    for (auto size: sizes) {
+      ++testCount;
+      if (!TestSingle<Traits>(sizes.back(), size))
+        ++failCount;
+    }
+    if constexpr (Traits::Bits >= 32) {
+      ++testCount;
+      if (!TestDouble<Traits>(64))
+        ++failCount;
+    }
+    ++testCount;
+    if (!TestUncorrectable<Traits>(16))
+      ++failCount;
+  });
+
+  std::cout << failCount << '/' << testCount
+            << " tests failed." << std::endl;
+  return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
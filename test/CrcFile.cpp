@@ -6,6 +6,8 @@
 #include <chrono>
 #include <filesystem>
 #include <vector>
+#include <memory_resource>
+#include <thread>
 #include <random>
 #include <string_view>
 #include <iostream>
@@ -61,26 +63,187 @@ int main() {
       }
       out.close();
     }
-    {
+    // Times one way of computing the CRC of the file.
+    auto run = [&](const char* label, auto fileCrcFn) {
       using namespace std;
       auto saveId = tjg::SaveIo{cerr};
-      cerr << "Running FileCrc..." << flush;
+      cerr << "Running " << label << "..." << flush;
       auto start = Clock::now();
-      auto fileCrc = tjg::crc::FileCrc(fname);
+      auto fileCrc = fileCrcFn(fname);
       auto stop  = Clock::now();
       tjg::SetHex(cerr);
       cerr << " done crc=0x" << setw(8) << fileCrc.value() << dec << ' ' << fileCrc.value() << endl;
       auto s = chrono::duration<double>(stop - start);
+      cout << setw(16) << left << label << ' ';
       if (s.count() == 0.0) {
         cout << "Rate = infinite\n";
       } else {
         auto rate = FileSize / s.count();
         cout << "Rate = " << (rate/(1<<20)) << " MiB/s\n";
       }
-      if (fileCrc != ExpectedCrc) {
-        cout << "Failed." << endl;
-        return EXIT_FAILURE;
+      return fileCrc == ExpectedCrc;
+    }; // run
+
+    auto ok = run("FileCrc", [](const auto& f)
+                               { return tjg::crc::FileCrc(f); });
+#if defined(TJG_CRC_POSIX)
+    ok &= run("MappedFileCrc", [](const auto& f)
+                                 { return tjg::crc::MappedFileCrc(f); });
+#endif
+#if defined(TJG_CRC_URING)
+    ok &= run("UringFileCrc", [](const auto& f)
+                                { return tjg::crc::UringFileCrc(f); });
+    ok &= run("O_DIRECT", [](const auto& f) {
+                return tjg::crc::UringFileCrc(f,
+                         tjg::crc::Known<tjg::crc::Crc32IsoHdlc, 8>{},
+                         8, 1<<20, true);
+              });
+    {
+      // Errors with reads still in flight: a directory fails every read,
+      // and a sysfs file is shorter than its stated size, as if truncated.
+      const auto dir = fs::path{"uring.tmp"};
+      fs::create_directory(dir);
+      for (auto name: {"a", "b", "c", "d"})
+        std::ofstream{dir / name};
+      auto fails = [](const fs::path& f) {
+        try {
+          tjg::crc::UringFileCrc(f, tjg::crc::Known<tjg::crc::Crc32IsoHdlc>{},
+                                 4, 16);
+        } catch (const std::exception&) {
+          return true;
+        }
+        return false;
+      };
+      const auto sysfs = fs::path{"/sys/devices/system/cpu/online"};
+      auto errorOk = fails(dir) && (!fs::exists(sysfs) || fails(sysfs))
+                  && (tjg::crc::UringFileCrc(fname) == ExpectedCrc);
+      std::cout << "UringFileCrc err " << (errorOk ? "PASSED" : "FAILED")
+                << std::endl;
+      ok &= errorOk;
+      fs::remove_all(dir);
+    }
+#endif
+#if defined(TJG_CRC_POSIX)
+    ok &= run("ParallelFileCrc", [](const auto& f)
+                                   { return tjg::crc::ParallelFileCrc(f); });
+    {
+      // The CRCs of two ranges, appended, are the CRC of the whole.
+      using tjg::crc::FileRange;
+      constexpr auto Split = std::uint64_t{12345679};
+      auto crc = tjg::crc::Known<tjg::crc::Crc32IsoHdlc, 8>{};
+      auto head = tjg::crc::ParallelFileCrc(fname, crc, FileRange{0, Split});
+      auto tail = tjg::crc::ParallelFileCrc(fname, crc, FileRange{Split});
+      head.append(tail.value(), FileSize - Split);
+      auto rangeOk = (head == ExpectedCrc);
+      std::cout << "FileRange        " << (rangeOk ? "PASSED" : "FAILED")
+                << std::endl;
+      ok &= rangeOk;
+    }
+    ok &= run("FdCrc", [](const auto& f) {
+                auto fd = tjg::crc::detail::OpenRead(f);
+                return tjg::crc::FdCrc(fd.get());
+              });
+    ok &= run("TeeCrc", [](const auto& f) {
+                auto in  = tjg::crc::detail::OpenRead(f);
+                auto out = tjg::crc::detail::FileDesc{
+                             ::open("/dev/null", O_WRONLY | O_CLOEXEC)};
+                if (!out)
+                  tjg::crc::detail::ThrowErrno("open /dev/null");
+                return tjg::crc::TeeCrc(in.get(), out.get());
+              });
+    {
+      // From a pipe, which is teed directly, to a regular file.  The pipe
+      // is fed by another TeeCrc, from the file.
+      using tjg::crc::detail::FileDesc;
+      const auto copy = fs::path{"tee.tmp"};
+      int fds[2];
+      if (::pipe2(fds, O_CLOEXEC) != 0)
+        tjg::crc::detail::ThrowErrno("pipe2");
+      auto r = FileDesc{fds[0]};
+      auto w = FileDesc{fds[1]};
+      auto out = FileDesc{::open(copy.c_str(),
+                                 O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                 0644)};
+      if (!out)
+        tjg::crc::detail::ThrowErrno("open tee.tmp");
+      auto sent = std::uint32_t{0};
+      auto writer = std::jthread{[&] {
+        auto in = tjg::crc::detail::OpenRead(fname);
+        sent = tjg::crc::TeeCrc(in.get(), w.get()).value();
+        w = FileDesc{};
+      }};
+      auto got = tjg::crc::TeeCrc(r.get(), out.get());
+      writer.join();
+      auto pipeOk = (sent == ExpectedCrc && got == ExpectedCrc
+                     && tjg::crc::FileCrc(copy) == ExpectedCrc);
+      std::cout << "TeeCrc from pipe " << (pipeOk ? "PASSED" : "FAILED")
+                << std::endl;
+      ok &= pipeOk;
+      fs::remove(copy);
+    }
+    {
+      // A mostly-empty sparse file: SparseFileCrc reads only the data.
+      // FdCrc reads every byte.
+      using namespace std;
+      constexpr auto SparseSize = std::uint64_t{256} << 20;
+      const auto sparse = fs::path{"sparse.tmp"};
+      {
+        auto fd = tjg::crc::detail::FileDesc{
+                    ::open(sparse.c_str(),
+                           O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+        if (!fd || ::ftruncate(fd.get(), SparseSize) != 0)
+          tjg::crc::detail::ThrowErrno("sparse.tmp");
+        auto block = vector<char>(1<<20);
+        for (auto& c: block)
+          c = static_cast<char>(rng());
+        for (auto at: {std::uint64_t{0}, SparseSize / 3, SparseSize - 4000}) {
+          auto n = static_cast<size_t>(min<std::uint64_t>(block.size(),
+                                                          SparseSize - at));
+          if (::pwrite(fd.get(), block.data(), n, static_cast<off_t>(at))
+              != static_cast<ssize_t>(n))
+          {
+            tjg::crc::detail::ThrowErrno("pwrite");
+          }
+        }
       }
+      auto time = [](auto f) {
+        auto start = Clock::now();
+        auto crc = f();
+        auto s = chrono::duration<double>(Clock::now() - start);
+        return pair{crc, s.count()};
+      };
+      auto [full, tFull] = time([&] {
+                             auto fd = tjg::crc::detail::OpenRead(sparse);
+                             return tjg::crc::FdCrc(fd.get());
+                           });
+      auto [skip, tSkip] = time([&] {
+                             return tjg::crc::SparseFileCrc(sparse);
+                           });
+      auto par = tjg::crc::ParallelFileCrc(sparse, 4);
+      // FileCrc and FileCksum skip the holes too.
+      auto cksum = [&] {
+        auto fd = tjg::crc::detail::OpenRead(sparse);
+        auto crc = tjg::crc::FdCrc(fd.get(),
+                                   tjg::crc::Known<tjg::crc::Crc32Cksum, 8>{});
+        tjg::crc::detail::AppendLength(crc, SparseSize);
+        return crc.value();
+      }();
+      auto& mr = *std::pmr::new_delete_resource();
+      auto sparseOk = (skip == full.value() && par == full.value()
+                       && tjg::crc::FileCrc(sparse) == full.value()
+                       && tjg::crc::FileCrc(sparse.string(), mr)
+                          == full.value()
+                       && tjg::crc::FileCksum(sparse) == cksum);
+      cout << "SparseFileCrc    " << (sparseOk ? "PASSED" : "FAILED")
+           << " (" << tSkip * 1e3 << " ms vs " << tFull * 1e3
+           << " ms reading every byte)" << endl;
+      ok &= sparseOk;
+      fs::remove(sparse);
+    }
+#endif
+    if (!ok) {
+      std::cout << "Failed." << std::endl;
+      return EXIT_FAILURE;
     }
 
     return EXIT_SUCCESS;
@@ -0,0 +1,166 @@
+#include "crc/CrcFileCache.hpp"
+#include "crc/CrcFile.hpp"
+#include "crc/CrcKnown.hpp"
+#include "test/TestCheck.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <random>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+namespace fs = std::filesystem;
+using namespace tjg::crc;
+
+using namespace tjg::test;
+
+namespace {
+
+/// Writes `n` random bytes to `name`, dated `age` ago.
+void Write(const fs::path& name, std::size_t n,
+           std::chrono::minutes age = std::chrono::minutes{60})
+{
+  WriteRandom(name, 0, n);
+  fs::resize_file(name, n);
+  Backdate(name, age);
+} // Write
+
+bool Cached(CrcCache& cache, const fs::path& name, const char* algorithm) {
+  return cache.find(CrcCache::MakeKey(detail::Stat(name), algorithm))
+         .has_value();
+}
+
+bool TestCache(const fs::path& dir) {
+  auto name = dir / "data";
+  auto ok = true;
+  Write(name, 100000);
+  {
+    auto cache = CrcCache{dir / "cache", 64};
+    ok &= (cache.slots() == 64 && !Cached(cache, name, Crc32IsoHdlc::Name));
+    ok &= (FileCrc(name, cache) == FileCrc(name));
+    ok &= Cached(cache, name, Crc32IsoHdlc::Name);
+    // Hits are appended to the CRC's current state.
+    auto crc = Known<Crc32IsoHdlc>{};
+    crc.update(std::byte{42});
+    ok &= (FileCrc(name, crc, cache) == FileCrc(name, crc));
+    // Algorithms are cached separately.
+    ok &= !Cached(cache, name, Crc32Cksum::Name);
+    ok &= (FileCksum(name, cache) == FileCksum(name));
+    ok &= (FileCksum(name, cache) == FileCksum(name));
+    ok &= Cached(cache, name, Crc32Cksum::Name);
+  }
+  // The cache persists, and another instance sees the same entries.
+  auto cache = CrcCache{dir / "cache", 1024};
+  ok &= (cache.slots() == 64 && Cached(cache, name, Crc32IsoHdlc::Name));
+  // A modified file misses, then replaces its entry.
+  Write(name, 100001, std::chrono::minutes{30});
+  ok &= !Cached(cache, name, Crc32IsoHdlc::Name);
+  ok &= (FileCrc(name, cache) == FileCrc(name));
+  ok &= Cached(cache, name, Crc32IsoHdlc::Name);
+  // A file modified just now is not cached.
+  Write(name, 1000, std::chrono::minutes{0});
+  ok &= (FileCrc(name, cache) == FileCrc(name));
+  ok &= !Cached(cache, name, Crc32IsoHdlc::Name);
+  return ok;
+} // TestCache
+
+bool TestNotCache(const fs::path& dir) {
+  auto name = dir / "junk";
+  Write(name, 1000);
+  try {
+    auto cache = CrcCache{name};
+    return false;
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+} // TestNotCache
+
+/// A writer that died mid-write leaves its slot odd; later inserts for the
+/// same file must use another slot.
+bool TestDeadWriter(const fs::path& dir) {
+  auto file = dir / "dead";
+  auto cache = CrcCache{file, 8};
+  auto key = CrcCache::Key{1, 1234, 10, 100, 100, CrcCache::Algorithm("x")};
+  cache.insert(key, 42);
+  auto ok = (cache.find(key) == 42);
+  // Find the slot by its inode field and leave it mid-write.
+  {
+    auto f = std::fstream{file, std::ios::in | std::ios::out
+                                | std::ios::binary};
+    for (std::uint64_t at = 64; at != 64 + 8 * 64; at += 64) {
+      std::uint64_t x;
+      f.seekg(static_cast<std::streamoff>(at + 16));
+      f.read(reinterpret_cast<char*>(&x), sizeof(x));
+      if (x == key.ino) {
+        f.seekg(static_cast<std::streamoff>(at));
+        f.read(reinterpret_cast<char*>(&x), sizeof(x));
+        x |= 1;
+        f.seekp(static_cast<std::streamoff>(at));
+        f.write(reinterpret_cast<const char*>(&x), sizeof(x));
+      }
+    }
+  }
+  ok &= !cache.find(key).has_value();
+  key.mtimeNs = key.ctimeNs = 200;
+  cache.insert(key, 43);
+  return ok && cache.find(key) == 43;
+} // TestDeadWriter
+
+/// Threads insert and look up overlapping keys in a small table; every
+/// value found must be the one stored for its key.
+bool TestConcurrent(const fs::path& dir) {
+  auto cache = CrcCache{dir / "shared", 16};
+  auto valueOf = [](std::uint64_t i) { return i * 0x9e37'79b9 + 7; };
+  auto keyOf = [](std::uint64_t i) {
+    return CrcCache::Key{1, i % 50, i, static_cast<std::int64_t>(i), 0,
+                         CrcCache::Algorithm("test")};
+  };
+  auto bad = std::atomic<int>{0};
+  auto hits = std::atomic<int>{0};
+  {
+    auto workers = std::vector<std::jthread>{};
+    for (unsigned t = 0; t != 4; ++t) {
+      workers.emplace_back([&, t] {
+        auto rng = std::mt19937_64{t};
+        for (int n = 0; n != 100000; ++n) {
+          auto i = rng() % 200;
+          if (rng() & 1) {
+            cache.insert(keyOf(i), valueOf(i));
+          } else if (auto v = cache.find(keyOf(i))) {
+            ++hits;
+            if (*v != valueOf(i))
+              ++bad;
+          }
+        }
+      });
+    }
+  } // join
+  return bad == 0 && hits > 0;
+} // TestConcurrent
+
+} // anonymous
+
+int main() {
+  auto dir = fs::temp_directory_path() / "CrcFileCache.tmp";
+  try {
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    Check(TestCache(dir), "CrcCache hits, misses and invalidation");
+    Check(TestNotCache(dir), "CrcCache rejects other files");
+    Check(TestDeadWriter(dir), "CrcCache slot left by a dead writer");
+    Check(TestConcurrent(dir), "CrcCache concurrent access");
+    fs::remove_all(dir);
+  }
+  catch (std::exception& x) {
+    std::cerr << "Caught exception: " << x.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return Summary();
+} // main
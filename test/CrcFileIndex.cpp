@@ -0,0 +1,206 @@
+#include "crc/CrcFileIndex.hpp"
+#include "crc/CrcFile.hpp"
+#include "crc/CrcKnown.hpp"
+#include "test/TestCheck.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <iterator>
+#include <vector>
+#include <span>
+#include <random>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+namespace fs = std::filesystem;
+using namespace tjg::crc;
+
+using namespace tjg::test;
+
+namespace {
+
+constexpr std::uint64_t BlockSize = 1 << 16;
+
+using Index = FileCrcIndex<Crc32IsoHdlc>;
+
+/// Writes `n` random bytes at `offset`, then backdates the file so that
+/// the index does not consider it racy.  Each write is dated a minute
+/// after the last.
+void Write(const fs::path& name, std::uint64_t offset, std::size_t n) {
+  WriteRandom(name, offset, n);
+  static auto age = std::chrono::minutes{60};
+  age -= std::chrono::minutes{1};
+  Backdate(name, age);
+} // Write
+
+/// Updates a fresh index, as a later run would, and checks that it read
+/// `blocks` blocks and agrees with FileCrc.
+bool Expect(const fs::path& name, std::uint64_t blocks,
+            std::span<const FileRange> dirty = {})
+{
+  auto index = Index{name, {}, BlockSize};
+  auto crc = index.update(dirty);
+  auto ok = (crc == FileCrc(name).value() && index.blocksRead() == blocks);
+  if (!ok) {
+    std::cout << "  read " << index.blocksRead() << " blocks, expected "
+              << blocks << std::endl;
+  }
+  return ok;
+} // Expect
+
+bool TestIndex(const fs::path& name) {
+  auto ok = true;
+  Write(name, 0, 5 * BlockSize + 1000);
+  ok &= Expect(name, 6);
+  ok &= Expect(name, 0);
+  // In-place change, with and without the caller's dirty ranges.
+  Write(name, 2 * BlockSize + 10, 5);
+  auto dirty = std::vector<FileRange>{{2 * BlockSize + 10, 5}};
+  ok &= Expect(name, 1, dirty);
+  Write(name, 3 * BlockSize - 2, 4);
+  ok &= Expect(name, 6);
+  Write(name, 3 * BlockSize - 2, 4);
+  dirty = {{3 * BlockSize - 2, 4}};
+  ok &= Expect(name, 2, dirty);
+  // Append: the partial last block grows and a new block appears.
+  auto size = fs::file_size(name);
+  Write(name, size, BlockSize);
+  dirty = {{size, FileRange::ToEnd}};
+  ok &= Expect(name, 2, dirty);
+  ok &= Expect(name, 0);
+  // Truncate to a block boundary: nothing need be read.
+  fs::resize_file(name, 4 * BlockSize);
+  Write(name, 0, 0);
+  dirty = {{4 * BlockSize, FileRange::ToEnd}};
+  ok &= Expect(name, 0, dirty);
+  return ok;
+} // TestIndex
+
+bool TestRacy(const fs::path& name) {
+  // A file modified just now may change again within its mtime tick.
+  Write(name, 0, 1000);
+  fs::last_write_time(name, fs::file_time_type::clock::now());
+  auto ok = Expect(name, 1) && Expect(name, 1);
+  Write(name, 0, 0);
+  return ok && Expect(name, 1) && Expect(name, 0);
+} // TestRacy
+
+bool TestInvalidSidecar(const fs::path& name) {
+  Write(name, 0, 3 * BlockSize);
+  auto ok = Expect(name, 3) && Expect(name, 0);
+  // Another block size or algorithm ignores the sidecar.
+  {
+    auto index = FileCrcIndex<Crc32IsoHdlc>{name, {}, BlockSize / 2};
+    ok &= (index.update() == FileCrc(name).value()
+           && index.blocksRead() == 6);
+  }
+  {
+    auto index = FileCrcIndex<Crc32Iscsi>{name, {}, BlockSize};
+    ok &= (index.update() == FileCrc(name, Known<Crc32Iscsi>{}).value()
+           && index.blocksRead() == 3);
+  }
+  // A corrupt sidecar is rebuilt.
+  ok &= Expect(name, 3) && Expect(name, 0);
+  fs::resize_file(fs::path{name} += ".crcidx", 100);
+  ok &= Expect(name, 3) && Expect(name, 0);
+  return ok;
+} // TestInvalidSidecar
+
+bool TestReplaced(const fs::path& name) {
+  Write(name, 0, 4 * BlockSize);
+  auto ok = Expect(name, 4) && Expect(name, 0);
+  // Same size, but another inode: the caller's dirty range is not enough.
+  auto other = fs::path{name} += ".new";
+  fs::copy_file(name, other);
+  Write(other, 0, BlockSize);
+  fs::rename(other, name);
+  auto dirty = std::vector<FileRange>{{3 * BlockSize, 10}};
+  return ok && Expect(name, 4, dirty) && Expect(name, 0);
+} // TestReplaced
+
+/// Overwrites the 8-byte little-endian field at `offset` of `name`.
+void Poke(const fs::path& name, std::uint64_t offset, std::uint64_t x) {
+  auto f = std::fstream{name, std::ios::in | std::ios::out | std::ios::binary};
+  f.seekp(static_cast<std::streamoff>(offset));
+  for (int i = 0; i != 8; ++i, x >>= 8)
+    f.put(static_cast<char>(x & 0xff));
+} // Poke
+
+bool TestCorruptCount(const fs::path& name) {
+  Write(name, 0, 2 * BlockSize);
+  auto ok = Expect(name, 2) && Expect(name, 0);
+  // A huge size and a block count to match are rejected, not allocated.
+  auto sidecar = fs::path{name} += ".crcidx";
+  constexpr auto SizeAt = 8 + 7 * 8 + 2 * 8;
+  constexpr auto CountAt = SizeAt + 3 * 8;
+  constexpr auto Huge = std::uint64_t{1} << 62;
+  Poke(sidecar, SizeAt, Huge);
+  Poke(sidecar, CountAt, Huge / BlockSize);
+  ok &= Expect(name, 2);
+  Poke(sidecar, SizeAt, ~std::uint64_t{0});
+  Poke(sidecar, CountAt, ~std::uint64_t{0} / BlockSize + 1);
+  return ok && Expect(name, 2);
+} // TestCorruptCount
+
+bool TestConcurrentSave(const fs::path& dir) {
+  // Indexes of one file in several threads each save the sidecar; every
+  // save must be whole and leave no temporary behind.
+  fs::create_directory(dir);
+  auto name = dir / "data";
+  Write(name, 0, 3 * BlockSize);
+  auto expected = FileCrc(name).value();
+  auto ok = std::atomic<bool>{true};
+  {
+    auto workers = std::vector<std::jthread>{};
+    for (int t = 0; t != 4; ++t) {
+      workers.emplace_back([&] {
+        try {
+          for (int i = 0; i != 50; ++i) {
+            if (Index{name, {}, BlockSize}.update() != expected)
+              ok = false;
+          }
+        } catch (const std::exception&) {
+          ok = false;
+        }
+      });
+    }
+  } // join
+  auto files = std::distance(fs::directory_iterator{dir},
+                             fs::directory_iterator{});
+  return ok && files == 2 && Expect(name, 0);
+} // TestConcurrentSave
+
+bool TestEmpty(const fs::path& name) {
+  std::ofstream{name, std::ios::binary};
+  Write(name, 0, 0);
+  return Expect(name, 0) && Expect(name, 0);
+} // TestEmpty
+
+} // anonymous
+
+int main() {
+  auto dir = fs::temp_directory_path() / "CrcFileIndex.tmp";
+  try {
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    Check(TestIndex(dir / "a"), "FileCrcIndex incremental updates");
+    Check(TestRacy(dir / "b"), "FileCrcIndex racy mtime");
+    Check(TestInvalidSidecar(dir / "c"), "FileCrcIndex invalid sidecar");
+    Check(TestEmpty(dir / "d"), "FileCrcIndex empty file");
+    Check(TestReplaced(dir / "e"), "FileCrcIndex replaced file");
+    Check(TestCorruptCount(dir / "f"), "FileCrcIndex corrupt block count");
+    Check(TestConcurrentSave(dir / "g"), "FileCrcIndex concurrent saves");
+    fs::remove_all(dir);
+  }
+  catch (std::exception& x) {
+    std::cerr << "Caught exception: " << x.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return Summary();
+} // main
@@ -0,0 +1,181 @@
+#include "crc/CrcFileResume.hpp"
+#include "crc/CrcBuffered.hpp"
+#include "crc/CrcFile.hpp"
+#include "crc/CrcKnown.hpp"
+#include "test/TestCheck.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iterator>
+#include <span>
+#include <random>
+#include <type_traits>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+namespace fs = std::filesystem;
+using namespace tjg::crc;
+
+static_assert(std::is_copy_assignable_v<Known<Crc32IsoHdlc>>);
+static_assert(std::is_copy_assignable_v<Crc<16, 0x1021, Endian::MsbFirst>>);
+
+// A checkpoint restored into a fresh CRC continues the message.
+static_assert([] {
+    auto a = Known<Crc12Umts>{};
+    auto c = Known<Crc12Umts>{};
+    for (auto x: {'1', '2'}) {
+      a.update(std::byte(x));
+      c.update(std::byte(x));
+    }
+    auto b = Known<Crc12Umts>{};
+    b.restore(a.value());
+    for (auto x: {'3', '4'}) {
+      b.update(std::byte(x));
+      c.update(std::byte(x));
+    }
+    return b.value() == c.value();
+  }());
+
+using namespace tjg::test;
+
+namespace {
+
+/// Checkpoints a CRC at every split point of a message and resumes it.
+template<class C>
+bool TestRestore() {
+  auto msg = std::vector<std::byte>(300);
+  for (auto& b: msg)
+    b = static_cast<std::byte>(Rng());
+  auto whole = C{};
+  whole.update(msg);
+  for (std::size_t i = 0; i <= msg.size(); i += 7) {
+    auto head = C{};
+    head.update(std::span{msg}.first(i));
+    auto tail = C{};
+    tail.update(std::byte{99});  // Discarded by restore().
+    tail.restore(head.value());
+    tail.update(std::span{msg}.subspan(i));
+    if (tail.value() != whole.value())
+      return false;
+  }
+  auto copy = C{};
+  copy = whole;
+  return copy.value() == whole.value();
+} // TestRestore
+
+void Append(const fs::path& name, std::size_t n) {
+  WriteRandom(name, fs::exists(name) ? fs::file_size(name) : 0, n);
+} // Append
+
+/// Updates a fresh helper, as a later run would, and checks that it read
+/// `bytes` bytes and agrees with FileCrc.
+bool Expect(const fs::path& name, std::uint64_t bytes) {
+  auto crc = ResumableFileCrc<Crc32IsoHdlc>{name};
+  auto v = crc.update();
+  auto ok = (v == FileCrc(name).value() && crc.bytesRead() == bytes
+             && crc.length() == fs::file_size(name));
+  if (!ok) {
+    std::cout << "  read " << crc.bytesRead() << " bytes, expected "
+              << bytes << std::endl;
+  }
+  return ok;
+} // Expect
+
+bool TestResume(const fs::path& dir) {
+  auto name = dir / "log";
+  Append(name, 100000);
+  auto ok = Expect(name, 100000);
+  ok &= Expect(name, 0);
+  Append(name, 500);
+  ok &= Expect(name, 500);
+  Append(name, 1);
+  ok &= Expect(name, 1);
+  // Truncation and in-place rewrites start over.
+  fs::resize_file(name, 50000);
+  ok &= Expect(name, 50000);
+  {
+    auto f = std::fstream{name, std::ios::in | std::ios::out
+                                | std::ios::binary};
+    f.seekp(49990);
+    f.put('x');
+  }
+  ok &= Expect(name, 50000);
+  // So does a replaced file, even one of the same length.
+  auto other = dir / "other";
+  fs::copy_file(name, other);
+  Append(other, 10);
+  fs::rename(other, name);
+  ok &= Expect(name, 50010);
+  ok &= Expect(name, 0);
+  // And a corrupt state file.
+  fs::resize_file(fs::path{name} += ".crcstate", 20);
+  ok &= Expect(name, 50010);
+  return ok;
+} // TestResume
+
+bool TestConcurrentSave(const fs::path& dir) {
+  // Helpers for one file in several threads each save the state; every
+  // save must be whole and leave no temporary behind.
+  fs::create_directory(dir);
+  auto name = dir / "log";
+  Append(name, 10000);
+  auto expected = FileCrc(name).value();
+  auto ok = std::atomic<bool>{true};
+  {
+    auto workers = std::vector<std::jthread>{};
+    for (int t = 0; t != 4; ++t) {
+      workers.emplace_back([&] {
+        try {
+          for (int i = 0; i != 50; ++i) {
+            if (ResumableFileCrc<Crc32IsoHdlc>{name}.update() != expected)
+              ok = false;
+          }
+        } catch (const std::exception&) {
+          ok = false;
+        }
+      });
+    }
+  } // join
+  auto files = std::distance(fs::directory_iterator{dir},
+                             fs::directory_iterator{});
+  return ok && files == 2 && Expect(name, 0);
+} // TestConcurrentSave
+
+bool TestEmpty(const fs::path& dir) {
+  auto name = dir / "empty";
+  std::ofstream{name, std::ios::binary};
+  auto ok = Expect(name, 0) && Expect(name, 0);
+  Append(name, 10);
+  return ok && Expect(name, 10);
+} // TestEmpty
+
+} // anonymous
+
+int main() {
+  auto dir = fs::temp_directory_path() / "CrcFileResume.tmp";
+  try {
+    Check(TestRestore<Known<Crc32IsoHdlc>>(), "restore CRC-32/ISO-HDLC");
+    Check(TestRestore<Known<Crc12Umts>>(), "restore CRC-12/UMTS");
+    Check(TestRestore<Known<Crc5Usb>>(), "restore CRC-5/USB");
+    Check(TestRestore<Known<Crc64Xz>>(), "restore CRC-64/XZ");
+    Check(TestRestore<BufferedCrc<Crc64Xz>>(), "restore BufferedCrc");
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    Check(TestResume(dir), "ResumableFileCrc appends and resets");
+    Check(TestEmpty(dir), "ResumableFileCrc empty file");
+    Check(TestConcurrentSave(dir / "concurrent"),
+          "ResumableFileCrc concurrent saves");
+    fs::remove_all(dir);
+  }
+  catch (std::exception& x) {
+    std::cerr << "Caught exception: " << x.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return Summary();
+} // main
@@ -0,0 +1,99 @@
+#include "crc/CrcHamming.hpp"
+
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+
+// Remainder of the n-bit error polynomial `e` divided by x^Bits + poly.
+template<std::size_t Bits>
+std::uint64_t Mod(std::uint64_t e, unsigned n, std::uint64_t poly) {
+  for (unsigned i = n; i-- > Bits; ) {
+    if ((e >> i) & 1)
+      e ^= (std::uint64_t{1} << i) | (poly << (i - Bits));
+  }
+  return e;
+} // Mod
+
+// Counts undetected errors of weight w in n bits by enumerating them all.
+template<std::size_t Bits>
+std::uint64_t BruteForce(unsigned n, unsigned w, std::uint64_t poly) {
+  auto count = std::uint64_t{0};
+  auto e = (std::uint64_t{1} << w) - 1;
+  while (e < (std::uint64_t{1} << n)) {
+    count += (Mod<Bits>(e, n, poly) == 0);
+    // Next pattern of the same weight.
+    auto c = e & -e;
+    auto r = e + c;
+    e = (((r ^ e) >> 2) / c) | r;
+  }
+  return count;
+} // BruteForce
+
+template<std::size_t Bits>
+bool Test(std::uint64_t poly, unsigned maxBits) {
+  std::cout << "Testing " << Bits << "-bit poly 0x" << std::hex << poly
+            << std::dec << " up to " << maxBits << " bits";
+  auto hamming = tjg::crc::HammingEvaluator<Bits>{
+    static_cast<tjg::uint_t<Bits>::least>(poly)};
+  for (unsigned n = Bits; n <= maxBits; ++n) {
+    auto r = hamming.evaluate(n - Bits, 5);
+    auto hd = 6u;
+    auto undetected = std::uint64_t{0};
+    for (unsigned w = 2; w <= 5; ++w) {
+      undetected = BruteForce<Bits>(n, w, poly);
+      if (undetected != 0) {
+        hd = w;
+        break;
+      }
+    }
+    if (r.hd != hd || r.undetected != undetected) {
+      std::cout << " FAILED at " << n << " bits: HD " << r.hd
+                << ", expected " << hd << std::endl;
+      return false;
+    }
+  }
+  std::cout << " PASSED" << std::endl;
+  return true;
+} // Test
+
+// Published maximum data-word lengths for a given HD.
+template<std::size_t Bits>
+bool TestLength(std::uint64_t poly, unsigned hd, std::uint64_t limit,
+                std::uint64_t expected)
+{
+  std::cout << "Testing " << Bits << "-bit poly 0x" << std::hex << poly
+            << std::dec << " HD " << hd;
+  auto hamming = tjg::crc::HammingEvaluator<Bits>{
+    static_cast<tjg::uint_t<Bits>::least>(poly)};
+  auto length = hamming.maxLength(hd, limit);
+  if (length != expected) {
+    std::cout << " FAILED: " << length << " bits, expected "
+              << expected << std::endl;
+    return false;
+  }
+  std::cout << " up to " << length << " bits PASSED" << std::endl;
+  return true;
+} // TestLength
+
+int main() {
+  int failCount = 0;
+  int testCount = 0;
+  auto check = [&](bool passed) { ++testCount; failCount += !passed; };
+
+  check(Test<5>(0x05, 40));
+  check(Test<8>(0x07, 40));
+  check(Test<8>(0x31, 40));
+  check(Test<8>(0x9b, 40));
+  check(Test<12>(0x80f, 40));
+  check(Test<16>(0x1021, 44));
+  check(Test<16>(0x8005, 44));
+
+  check(TestLength<8>(0x07, 4, 1000, 119));
+  check(TestLength<8>(0x07, 3, 1000, 119));
+  check(TestLength<12>(0x80f, 4, 5000, 2035));
+  check(TestLength<32>(0x04c11db7, 6, 300, 268));
+
+  std::cout << failCount << '/' << testCount
+            << " tests failed." << std::endl;
+  return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
@@ -0,0 +1,63 @@
+#include "crc/CrcIndex.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <vector>
+#include <span>
+#include <random>
+#include <iostream>
+#include <cstddef>
+#include <cstdlib>
+
+template<class CrcTraits>
+bool Test(std::span<const std::byte> data, std::size_t blockSize) {
+  using Crc = tjg::crc::Known<CrcTraits, tjg::crc::MaxSlices>;
+  std::cout << "Testing " << Crc::Name << " block size " << blockSize;
+  auto index = tjg::crc::CrcIndex<CrcTraits>{data, blockSize};
+  if (index.crc() != Crc{}(data).value()) {
+    std::cout << " FAILED whole buffer" << std::endl;
+    return false;
+  }
+  std::mt19937 rng{blockSize};
+  auto pick = std::uniform_int_distribution<std::size_t>{0, data.size()};
+  for (int i = 0; i != 200; ++i) {
+    auto a = pick(rng);
+    auto b = pick(rng);
+    if (a > b)
+      std::swap(a, b);
+    if (i < 10)
+      b = std::min(a + i, data.size());
+    if (index.crc(a, b) != Crc{}(data.subspan(a, b - a)).value()) {
+      std::cout << " FAILED [" << a << ", " << b << ')' << std::endl;
+      return false;
+    }
+  }
+  std::cout << " PASSED" << std::endl;
+  return true;
+} // Test
+
+int main() {
+  constexpr auto Seed = 12345;
+  std::mt19937 rng{Seed};
+
+  auto data = std::vector<std::byte>((1 << 20) + 12345);
+  for (auto& b: data)
+    b = static_cast<std::byte>(rng() & 0xff);
+
+  using namespace tjg::crc;
+  using Crcs = boost::mp11::mp_list<Crc5Usb, Crc12Umts, Crc16Kermit,
+                                    Crc32IsoHdlc, Crc32Mpeg2, Crc64We>;
+
+  int failCount = 0;
+  int testCount = 0;
+  boost::mp11::mp_for_each<Crcs>([&](auto I) {
+    for (std::size_t blockSize: {1000, 4096, 1 << 16}) {
+      ++testCount;
+      if (!Test<decltype(I)>(data, blockSize))
+        ++failCount;
+    }
+  });
+
+  std::cout << failCount << '/' << testCount
+            << " tests failed." << std::endl;
+  return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
@@ -0,0 +1,71 @@
+#include "crc/CrcParallel.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include "tjg/SaveIo.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <random>
+#include <iostream>
+#include <iomanip>
+#include <cstddef>
+#include <cstdlib>
+
+using Clock = std::chrono::high_resolution_clock;
+
+constexpr auto DataSize = std::size_t{256} << 20;
+
+template<class F>
+double Rate(F f) {
+  auto start = Clock::now();
+  f();
+  auto stop  = Clock::now();
+  auto s = std::chrono::duration<double>(stop - start);
+  return DataSize / (1 << 20) / s.count();
+} // Rate
+
+int main() {
+  using namespace std;
+  using Crc = tjg::crc::FastCrc32;
+
+  constexpr auto Seed = 12345;
+  std::mt19937_64 rng{Seed};
+
+  cerr << "Generating random bytes " << flush;
+  auto data = vector<std::byte>(DataSize);
+  for (std::size_t i = 0; i < DataSize; i += 8) {
+    auto x = rng();
+    for (int j = 0; j != 8; ++j, x >>= 8)
+      data[i+j] = static_cast<std::byte>(x & 0xff);
+  }
+  cerr << "done." << endl;
+
+  auto expected = Crc{};
+  auto seqRate = Rate([&] { expected.update(data); });
+
+  auto saveIo = tjg::SaveIo{cout};
+  cout << fixed << setprecision(0)
+       << "Threads    MiB/s  Speedup\n"
+       << "     seq " << setw(8) << seqRate << '\n';
+
+  int failed = 0;
+  auto maxThreads = std::max(2u, 2 * std::thread::hardware_concurrency());
+  for (auto n = 1u; n <= maxThreads; n *= 2) {
+    auto value = Crc::value_type{};
+    auto rate = Rate([&] {
+      value = tjg::crc::ParallelCrc(data, Crc{}, n).value();
+    });
+    cout << setw(8) << n << ' ' << setw(8) << rate
+         << setprecision(2) << setw(9) << (rate / seqRate)
+         << setprecision(0);
+    if (value != expected.value()) {
+      cout << " CRC WRONG!";
+      ++failed;
+    }
+    cout << '\n';
+  }
+  cout << flush;
+
+  return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
@@ -0,0 +1,100 @@
+#include "crc/CrcView.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <deque>
+#include <list>
+#include <vector>
+#include <array>
+#include <span>
+#include <ranges>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <iostream>
+#include <cstddef>
+#include <cstdlib>
+
+using Crc = tjg::crc::Known<tjg::crc::Crc32IsoHdlc, tjg::crc::MaxSlices>;
+
+int failCount = 0;
+
+void Check(const char* name, Crc::value_type got, Crc::value_type expected) {
+  std::cout << "Testing " << name;
+  if (got == expected) {
+    std::cout << " PASSED\n";
+  } else {
+    std::cout << " FAILED\n";
+    ++failCount;
+  }
+} // Check
+
+int main() {
+  constexpr auto Seed = 12345;
+  std::mt19937 rng{Seed};
+
+  auto data = std::vector<std::byte>{};
+  for (int i = 0; i != 10000; ++i)
+    data.push_back(static_cast<std::byte>(rng() & 0xff));
+
+  const auto expected = Crc{}(data).value();
+
+  {
+    auto dq = std::deque<std::byte>{data.begin(), data.end()};
+    auto crc = Crc{};
+    crc.update(dq);
+    Check("std::deque", crc.value(), expected);
+  }
+
+  {
+    auto lst = std::list<unsigned char>{};
+    for (auto b: data)
+      lst.push_back(std::to_integer<unsigned char>(b));
+    auto crc = Crc{};
+    crc.update(lst);
+    Check("std::list", crc.value(), expected);
+  }
+
+  auto segments = std::vector<std::span<const std::byte>>{};
+  for (std::size_t i = 0; i < data.size(); i += 777) {
+    auto n = std::min<std::size_t>(777, data.size() - i);
+    segments.emplace_back(data.data() + i, n);
+  }
+
+  {
+    auto crc = Crc{};
+    crc.update(segments);
+    Check("segments", crc.value(), expected);
+  }
+
+  {
+    auto crc = Crc{};
+    crc.update(segments | std::views::join);
+    Check("views::join", crc.value(), expected);
+  }
+
+  {
+    auto crc = Crc{};
+    crc.update(data | std::views::filter([](auto) { return true; }));
+    Check("views::filter", crc.value(), expected);
+  }
+
+  {
+    auto crc = Crc{};
+    auto sum = std::size_t{0};
+    for (auto b: data | tjg::crc::views::crc(crc))
+      sum += std::to_integer<std::size_t>(b);
+    Check("views::crc", crc.value(), expected);
+  }
+
+  {
+    auto crc = Crc{};
+    auto copy = std::vector<std::byte>{};
+    std::ranges::copy(tjg::crc::views::crc(segments | std::views::join, crc),
+                      std::back_inserter(copy));
+    Check("views::crc(join)", crc.value(), expected);
+    Check("views::crc copy", Crc{}(copy).value(), expected);
+  }
+
+  std::cout << failCount << " tests failed." << std::endl;
+  return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
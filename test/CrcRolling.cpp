@@ -0,0 +1,129 @@
+#include "crc/CrcRolling.hpp"
+#include "crc/CrcChunker.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <chrono>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <random>
+#include <iostream>
+#include <iomanip>
+#include <cstddef>
+#include <cstdlib>
+
+using Clock = std::chrono::high_resolution_clock;
+
+constexpr std::size_t Window = 48;
+
+template<class CrcTraits>
+bool Test(std::span<const std::byte> data) {
+  using Crc = tjg::crc::Known<CrcTraits>;
+  auto rolling = tjg::crc::RollingCrc<CrcTraits, Window>{};
+  std::cout << "Testing " << Crc::Name;
+  for (std::size_t i = 0; i != data.size(); ++i) {
+    rolling(data[i]);
+    auto first = (i + 1 >= Window) ? (i + 1 - Window) : 0;
+    auto expected = Crc{}(data.subspan(first, i + 1 - first)).value();
+    if (rolling.value() != expected) {
+      std::cout << " FAILED at " << i << std::endl;
+      return false;
+    }
+  }
+  std::cout << " PASSED" << std::endl;
+  return true;
+} // Test
+
+using Chunker = tjg::crc::CrcChunker<tjg::crc::Crc32Iscsi>;
+
+auto Chunks(std::span<const std::byte> data, std::size_t step) {
+  auto chunker = Chunker{2 << 10, 8 << 10, 64 << 10};
+  auto chunks = std::vector<Chunker::Chunk>{};
+  auto emit = [&](const Chunker::Chunk& c) { chunks.push_back(c); };
+  for (std::size_t i = 0; i < data.size(); i += step)
+    chunker.update(data.subspan(i, std::min(step, data.size() - i)), emit);
+  chunker.finish(emit);
+  return chunks;
+} // Chunks
+
+bool TestChunker(std::span<const std::byte> data) {
+  using Crc = tjg::crc::Known<tjg::crc::Crc32Iscsi>;
+  std::cout << "Testing CrcChunker";
+  auto start = Clock::now();
+  auto chunks = Chunks(data, data.size());
+  auto stop = Clock::now();
+  auto offset = std::uint64_t{0};
+  for (const auto& c: chunks) {
+    auto bytes = data.subspan(c.offset, c.size);
+    if (c.offset != offset || c.size > (64 << 10)
+        || (c.size < (2 << 10) && c.offset + c.size != data.size())
+        || c.crc != Crc{}(bytes).value())
+    {
+      std::cout << " FAILED at " << c.offset << std::endl;
+      return false;
+    }
+    offset += c.size;
+  }
+  if (offset != data.size()) {
+    std::cout << " FAILED: covered " << offset << " bytes" << std::endl;
+    return false;
+  }
+  for (std::size_t step: {1, 1000, 4096, 65536}) {
+    auto again = Chunks(data, step);
+    if (again.size() != chunks.size()
+        || !std::equal(again.begin(), again.end(), chunks.begin(),
+                       [](const auto& a, const auto& b)
+                       { return a.offset == b.offset && a.crc == b.crc; }))
+    {
+      std::cout << " FAILED with step " << step << std::endl;
+      return false;
+    }
+  }
+  auto s = std::chrono::duration<double>(stop - start);
+  std::cout << " PASSED " << chunks.size() << " chunks, "
+            << std::fixed << std::setprecision(0)
+            << (data.size() / s.count() / (1 << 20)) << " MiB/s" << std::endl;
+  return true;
+} // TestChunker
+
+int main() {
+  constexpr auto Seed = 12345;
+  std::mt19937 rng{Seed};
+
+  auto data = std::vector<std::byte>(4 << 20);
+  for (auto& b: data)
+    b = static_cast<std::byte>(rng() & 0xff);
+
+  int failCount = 0;
+
+  using Crcs = tjg::crc::test_detail::KnownCrcs;
+
+  using namespace boost::mp11;
+  mp_for_each<Crcs>([&](auto I) {
+    if (!Test<decltype(I)>(std::span{data}.first(200)))
+      ++failCount;
+  });
+
+  {
+    auto rolling = tjg::crc::RollingCrc<tjg::crc::Crc32Iscsi, Window>{};
+    auto start = Clock::now();
+    auto matches = 0;
+    for (auto b: data) {
+      rolling(b);
+      if ((rolling.value() & 0xfff) == 0)
+        ++matches;
+    }
+    auto stop = Clock::now();
+    auto s = std::chrono::duration<double>(stop - start);
+    std::cout << std::fixed << std::setprecision(0)
+              << "Rolling rate = " << (data.size() / s.count() / (1 << 20))
+              << " MiB/s, " << matches << " matches\n";
+  }
+
+  if (!TestChunker(data))
+    ++failCount;
+
+  std::cout << failCount << '/' << (mp_size<Crcs>::value + 1)
+            << " tests failed." << std::endl;
+  return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
@@ -0,0 +1,246 @@
+#include "crc/CrcSearch.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <vector>
+#include <span>
+#include <string>
+#include <string_view>
+#include <random>
+#include <algorithm>
+#include <iterator>
+#include <bit>
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+// Usage: CrcSearch [-w bits] hex-message:hex-crc...
+// Prints the catalogued models that match every sample.  If none does, it
+// searches for models of width `bits`, or of every width from the bit
+// width of the largest CRC up to 64 if -w is not given, and prints all it
+// finds.  With no arguments, runs the self test.
+
+namespace {
+
+using tjg::crc::CrcModel;
+using tjg::crc::CrcSample;
+
+std::ostream& operator<<(std::ostream& os, const CrcModel& m) {
+  auto digits = static_cast<int>((m.bits + 3) / 4);
+  os << std::hex << std::setfill('0')
+     << "width=" << std::dec << m.bits << std::hex
+     << " poly=0x" << std::setw(digits) << m.poly
+     << " init=0x" << std::setw(digits) << m.init
+     << " refin=" << std::boolalpha << m.reflectIn
+     << " refout=" << m.reflectOut
+     << " xorout=0x" << std::setw(digits) << m.xorOut << std::dec;
+  if (!m.name.empty())
+    os << " name=\"" << m.name << '"';
+  if (!m.unique)
+    os << " (init/xorout not unique)";
+  return os;
+} // operator<<
+
+// Checks the run-time model against the catalogue's check values.
+bool TestModel() {
+  std::cout << "Testing ModelCrc against the catalogue";
+  auto check = std::string_view{"123456789"};
+  auto bytes = std::as_bytes(std::span{check});
+  auto ok = true;
+  boost::mp11::mp_for_each<tjg::crc::test_detail::KnownCrcs>([&](auto I) {
+    using Traits = decltype(I);
+    // The catalogue's rare ReflectIn != ReflectOut entries have XorOut 0.
+    auto model = CrcModel{Traits::Bits, Traits::Poly, Traits::Init,
+                          Traits::ReflectIn, Traits::ReflectOut,
+                          Traits::XorOut, Traits::Name};
+    if (tjg::crc::ModelCrc(model, bytes) != Traits::Check) {
+      std::cout << " FAILED " << Traits::Name << std::endl;
+      ok = false;
+    }
+  });
+  if (ok)
+    std::cout << " PASSED" << std::endl;
+  return ok;
+} // TestModel
+
+// Random messages: `same` of `size` bytes, and two longer ones.
+std::vector<std::vector<std::byte>> Messages(std::size_t size,
+                                             std::mt19937& rng,
+                                             std::size_t same = 3)
+{
+  auto msgs = std::vector<std::vector<std::byte>>{};
+  auto sizes = std::vector<std::size_t>(same, size);
+  sizes.insert(sizes.end(), {size + 3, size + 7});
+  for (auto n: sizes) {
+    auto& msg = msgs.emplace_back(n);
+    for (auto& b: msg)
+      b = static_cast<std::byte>(rng() & 0xff);
+  }
+  return msgs;
+} // Messages
+
+template<class Traits>
+bool TestKnown(std::mt19937& rng) {
+  using Crc = tjg::crc::Known<Traits, tjg::crc::MaxSlices>;
+  std::cout << "Testing catalogue search for " << Traits::Name;
+  auto msgs = Messages(20, rng);
+  auto samples = std::vector<CrcSample>{};
+  for (auto& msg: msgs)
+    samples.push_back(CrcSample{msg, Crc{}(msg).value()});
+  auto found = tjg::crc::FindKnownCrcs(samples);
+  if (std::ranges::find(found, std::string_view{Traits::Name},
+                        &CrcModel::name) == found.end())
+  {
+    std::cout << " FAILED" << std::endl;
+    return false;
+  }
+  std::cout << " PASSED" << std::endl;
+  return true;
+} // TestKnown
+
+// Catalogued models that match `samples` and have width `bits`, if any;
+// otherwise a search at width `bits`, or at every width that can hold the
+// samples' CRCs if `bits` is 0.
+std::vector<CrcModel> Identify(std::span<const CrcSample> samples,
+                               std::size_t bits)
+{
+  auto found = tjg::crc::FindKnownCrcs(samples);
+  std::erase_if(found, [&](auto& m) { return bits != 0 && m.bits != bits; });
+  if (!found.empty())
+    return found;
+  if (bits != 0)
+    return tjg::crc::SearchCrcs(samples, bits);
+  auto largest = std::ranges::max(samples, {}, &CrcSample::crc).crc;
+  auto first = std::max<std::size_t>(std::bit_width(largest), 1);
+  for (auto w = first; w <= 64; ++w)
+    std::ranges::move(tjg::crc::SearchCrcs(samples, w),
+                      std::back_inserter(found));
+  return found;
+} // Identify
+
+// Did the search find a model equivalent to `model`?
+bool Found(const CrcModel& model, const std::vector<CrcModel>& found,
+           std::mt19937& rng)
+{
+  // Equivalent models may differ in init and xorOut; compare their CRCs.
+  auto fresh = Messages(40, rng);
+  auto equivalent = [&](const CrcModel& m) {
+    return m.unique && m.bits == model.bits && m.poly == model.poly
+        && std::ranges::all_of(fresh, [&](auto& msg) {
+             return tjg::crc::ModelCrc(m, msg)
+                 == tjg::crc::ModelCrc(model, msg);
+           });
+  };
+  if (std::ranges::none_of(found, equivalent)) {
+    std::cout << " FAILED" << std::endl;
+    for (auto& m: found)
+      std::cout << "  found " << m << std::endl;
+    return false;
+  }
+  std::cout << " PASSED" << std::endl;
+  return true;
+} // Found
+
+bool TestSearch(const CrcModel& model, std::mt19937& rng,
+                std::size_t same = 3)
+{
+  std::cout << "Testing search for " << model;
+  if (same < 3)
+    std::cout << " from " << same << " of one length";
+  auto msgs = Messages(12, rng, same);
+  auto samples = std::vector<CrcSample>{};
+  for (auto& msg: msgs)
+    samples.push_back(CrcSample{msg, tjg::crc::ModelCrc(model, msg)});
+  return Found(model, tjg::crc::SearchCrcs(samples, model.bits), rng);
+} // TestSearch
+
+// Search with no width given, as by the command line without -w.
+bool TestAnyWidth(const CrcModel& model, std::mt19937& rng) {
+  std::cout << "Testing search of every width for " << model;
+  auto msgs = Messages(12, rng);
+  auto samples = std::vector<CrcSample>{};
+  for (auto& msg: msgs)
+    samples.push_back(CrcSample{msg, tjg::crc::ModelCrc(model, msg)});
+  return Found(model, Identify(samples, 0), rng);
+} // TestAnyWidth
+
+int SelfTest() {
+  int failCount = 0;
+  int testCount = 0;
+  auto check = [&](bool passed) { ++testCount; failCount += !passed; };
+
+  std::mt19937 rng{12345};
+  check(TestModel());
+  using namespace tjg::crc;
+  check(TestKnown<Crc8Smbus>(rng));
+  check(TestKnown<Crc16Modbus>(rng));
+  check(TestKnown<Crc32IsoHdlc>(rng));
+  check(TestKnown<Crc64Xz>(rng));
+  check(TestSearch(CrcModel{5, 0x15, 0x0b, true, true, 0x1f}, rng));
+  check(TestSearch(CrcModel{8, 0x9b, 0xa5, false, false, 0x3c}, rng));
+  check(TestSearch(CrcModel{12, 0xd31, 0x5a5, true, false, 0x0}, rng));
+  check(TestSearch(CrcModel{16, 0x3d65, 0x1234, true, true, 0x5555}, rng));
+  check(TestSearch(CrcModel{16, 0xc867, 0xffff, false, false, 0xffff}, rng));
+  check(TestSearch(CrcModel{32, 0x741b8cd7, 0xffffffff, true, true, 0x0},
+                   rng));
+  check(TestSearch(CrcModel{64, 0xad93d23594c935a9, 0x0, false, true,
+                            0xffffffffffffffff}, rng));
+  // Too few equal-length pairs for the gcd alone to find the poly.
+  check(TestSearch(CrcModel{8, 0x2f, 0xff, false, false, 0xff}, rng, 2));
+  check(TestSearch(CrcModel{16, 0x8bb7, 0x0, true, false, 0x0}, rng, 1));
+  check(TestAnyWidth(CrcModel{12, 0xd31, 0x5a5, true, false, 0x0}, rng));
+  check(TestAnyWidth(CrcModel{24, 0x5d6dcb, 0xabcdef, false, false, 0x0},
+                     rng));
+
+  std::cout << failCount << '/' << testCount
+            << " tests failed." << std::endl;
+  return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // SelfTest
+
+std::vector<std::byte> FromHex(std::string_view hex) {
+  if (hex.size() % 2 != 0)
+    throw std::invalid_argument{"odd number of hex digits"};
+  auto bytes = std::vector<std::byte>{};
+  for (std::size_t i = 0; i != hex.size(); i += 2) {
+    auto s = std::string{hex.substr(i, 2)};
+    bytes.push_back(static_cast<std::byte>(std::stoul(s, nullptr, 16)));
+  }
+  return bytes;
+} // FromHex
+
+} // anonymous
+
+int main(int argc, char* argv[]) {
+  if (argc == 1)
+    return SelfTest();
+  try {
+    auto bits = std::size_t{0};
+    auto messages = std::vector<std::vector<std::byte>>{};
+    auto samples = std::vector<CrcSample>{};
+    for (int i = 1; i != argc; ++i) {
+      auto arg = std::string_view{argv[i]};
+      if (arg == "-w" && i + 1 != argc) {
+        bits = std::stoul(argv[++i]);
+        continue;
+      }
+      auto colon = arg.find(':');
+      if (colon == arg.npos)
+        throw std::invalid_argument{"expected hex-message:hex-crc"};
+      messages.push_back(FromHex(arg.substr(0, colon)));
+      auto crc = std::stoull(std::string{arg.substr(colon + 1)}, nullptr, 16);
+      samples.push_back(CrcSample{{}, crc});
+    }
+    for (std::size_t i = 0; i != samples.size(); ++i)
+      samples[i].message = messages[i];
+    auto found = Identify(samples, bits);
+    for (auto& m: found)
+      std::cout << m << '\n';
+    if (found.empty())
+      std::cout << "No model found." << std::endl;
+    return found.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+  } catch (const std::exception& x) {
+    std::cerr << "Error: " << x.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+} // main
@@ -0,0 +1,87 @@
+#include "crc/CrcStream.hpp"
+#include "crc/CrcKnown.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <iostream>
+#include <cstddef>
+#include <cstdlib>
+
+using Crc = tjg::crc::Known<tjg::crc::Crc32Iscsi, tjg::crc::MaxSlices>;
+
+int failCount = 0;
+
+void Check(const char* name, Crc::value_type got, Crc::value_type expected) {
+  std::cout << "Testing " << name;
+  if (got == expected) {
+    std::cout << " PASSED\n";
+  } else {
+    std::cout << " FAILED\n";
+    ++failCount;
+  }
+} // Check
+
+int main() {
+  constexpr auto Seed = 12345;
+  std::mt19937 rng{Seed};
+
+  auto big = std::string{};
+  for (int i = 0; i != 100000; ++i)
+    big.push_back(static_cast<char>(rng() & 0xff));
+
+  auto text = std::string{};
+  {
+    auto sink = std::ostringstream{};
+    auto buf = tjg::crc::CrcOStreamBuf<Crc>{sink.rdbuf(), Crc{}, 4096};
+    auto os = std::ostream{&buf};
+    for (int i = 0; i != 1000; ++i)
+      os << "record " << i << ' ' << (i * 0.5) << '\n';
+    os.write(big.data(), std::ssize(big));
+    os << "trailer";
+    auto early = buf.crc().value();
+    os.flush();
+    text = sink.str();
+    Check("CrcOStreamBuf before flush", early,
+          Crc{}(std::as_bytes(std::span{text})).value());
+    Check("CrcOStreamBuf", buf.crc().value(),
+          Crc{}(std::as_bytes(std::span{text})).value());
+  }
+
+  {
+    auto counter = tjg::crc::CrcOStreamBuf<Crc>{nullptr};
+    auto os = std::ostream{&counter};
+    os << text;
+    Check("CrcOStreamBuf(nullptr)", counter.crc().value(),
+          Crc{}(std::as_bytes(std::span{text})).value());
+  }
+
+  {
+    auto source = std::istringstream{text};
+    auto buf = tjg::crc::CrcIStreamBuf<Crc>{source.rdbuf(), Crc{}, 4096};
+    auto is = std::istream{&buf};
+    auto consumed = std::string{};
+    auto line = std::string{};
+    for (int i = 0; i != 500; ++i) {
+      std::getline(is, line);
+      consumed += line + '\n';
+    }
+    consumed.push_back(static_cast<char>(is.get()));
+    is.unget();
+    consumed.pop_back();
+    auto chunk = std::string(3, '\0');
+    is.read(chunk.data(), std::ssize(chunk));
+    consumed += chunk;
+    Check("CrcIStreamBuf partial", buf.crc().value(),
+          Crc{}(std::as_bytes(std::span{consumed})).value());
+    auto rest = std::string(text.size() - consumed.size(), '\0');
+    is.read(rest.data(), std::ssize(rest));
+    consumed += rest;
+    Check("CrcIStreamBuf", buf.crc().value(),
+          Crc{}(std::as_bytes(std::span{text})).value());
+  }
+
+  std::cout << failCount << " tests failed." << std::endl;
+  return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
@@ -7,6 +7,12 @@
 
 #include <concepts>
 #include <type_traits>
+#include <array>
+#include <span>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <cstdint>
 #include <cstddef>
 #include <cstdlib>
 
@@ -16,6 +22,17 @@ alignas(8) constexpr auto TestBuf = std::array<std::byte, 9>{
   std::byte{'7'}, std::byte{'8'}, std::byte{'9'}
 }; // TestBuf
 
+// Longer buffer of pseudo-random bytes.
+const auto LongBuf = [] {
+  auto buf = std::array<std::byte, 5000>{};
+  auto x = std::uint32_t{12345};
+  for (auto& b: buf) {
+    x = 1664525 * x + 1013904223;
+    b = static_cast<std::byte>(x >> 24);
+  }
+  return buf;
+}(); // LongBuf
+
 template<std::unsigned_integral U>
 struct CoutType: public std::conditional<(sizeof(U) == 1), unsigned, U> { };
 
@@ -51,18 +68,176 @@ bool Test() {
   return false;
 } // Test
 
+template<class CrcTraits>
+bool TestCombine() {
+  using namespace std;
+  using Crc = tjg::crc::Known<CrcTraits>;
+  cout << "Testing " << Crc::Name << " combine";
+  auto buf = std::span{TestBuf};
+  for (std::size_t k = 0; k <= buf.size(); ++k) {
+    auto a = Crc{}(buf.first(k)).value();
+    auto b = Crc{}(buf.subspan(k)).value();
+    if (Crc::Combine(a, b, buf.size() - k) != Crc::Check) {
+      cout << " FAILED at " << k << endl;
+      return false;
+    }
+  }
+  auto whole = Crc{}(LongBuf).value();
+  for (std::size_t k: {1, 100, 1234, 4095, 4999}) {
+    auto a = Crc{}(std::span{LongBuf}.first(k)).value();
+    auto b = Crc{}(std::span{LongBuf}.subspan(k)).value();
+    if (Crc::Combine(a, b, LongBuf.size() - k) != whole) {
+      cout << " FAILED at " << k << endl;
+      return false;
+    }
+  }
+  cout << " PASSED" << endl;
+  return true;
+} // TestCombine
+
+template<class CrcTraits>
+bool TestZeros() {
+  using namespace std;
+  using Crc = tjg::crc::Known<CrcTraits>;
+  cout << "Testing " << Crc::Name << " zeros";
+  static constexpr auto Zeros = std::array<std::byte, 5000>{};
+  for (std::size_t n: {0, 1, 3, 8, 255, 4096, 5000}) {
+    auto expected = Crc{}(TestBuf);
+    expected.update(std::span{Zeros}.first(n));
+    auto crc = Crc{}(TestBuf);
+    crc.updateZeros(n);
+    if (crc.value() != expected.value()) {
+      cout << " FAILED at " << n << endl;
+      return false;
+    }
+  }
+  cout << " PASSED" << endl;
+  return true;
+} // TestZeros
+
+template<class CrcTraits>
+bool TestShortSpans() {
+  using namespace std;
+  using tjg::crc::Known;
+  cout << "Testing " << Known<CrcTraits>::Name << " short spans";
+  // Spans shorter than the alignment prologue of the sliced kernels, at
+  // every misalignment, must match the bytewise kernel.
+  auto check = []<std::size_t Slices>() {
+    for (std::size_t offset = 0; offset != 8; ++offset) {
+      for (std::size_t n = 1; n != Slices; ++n) {
+        auto span = std::span{LongBuf}.subspan(offset, n);
+        if (Known<CrcTraits, Slices>{}(span).value()
+            != Known<CrcTraits, 1>{}(span).value())
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+  if (!check.template operator()<2>() || !check.template operator()<4>()
+      || !check.template operator()<8>())
+  {
+    cout << " FAILED" << endl;
+    return false;
+  }
+  cout << " PASSED" << endl;
+  return true;
+} // TestShortSpans
+
+template<class CrcTraits>
+bool TestPatch() {
+  using namespace std;
+  using Crc = tjg::crc::Known<CrcTraits>;
+  cout << "Testing " << Crc::Name << " patch";
+  auto buf = LongBuf;
+  auto crc = Crc{}(buf);
+  auto value = crc.value();
+  for (auto [offset, size]: {pair{0, 4}, pair{1, 1}, pair{777, 300},
+                             pair{4990, 10}})
+  {
+    auto before = std::array<std::byte, 300>{};
+    auto old = std::span{before}.first(size);
+    auto now = std::span{buf}.subspan(offset, size);
+    std::ranges::copy(now, old.begin());
+    for (auto& b: now)
+      b = ~b ^ std::byte{0x5a};
+    crc.patch(buf.size(), offset, old, now);
+    value = Crc::Patch(value, buf.size(), offset, old, now);
+    auto expected = Crc{}(buf).value();
+    if (crc.value() != expected || value != expected) {
+      cout << " FAILED at " << offset << endl;
+      return false;
+    }
+  }
+  // Unequal spans and bytes past the end are rejected, leaving the CRC.
+  auto rejects = [&]<class X>(std::uint64_t offset, std::size_t oldSize,
+                              std::size_t newSize)
+  {
+    try {
+      crc.patch(buf.size(), offset, std::span{buf}.first(oldSize),
+                std::span{buf}.first(newSize));
+    } catch (const X&) {
+      return crc.value() == value;
+    }
+    return false;
+  };
+  if (!rejects.template operator()<invalid_argument>(0, 4, 3)
+      || !rejects.template operator()<out_of_range>(buf.size() - 3, 4, 4)
+      || !rejects.template operator()<out_of_range>(~std::uint64_t{0}, 1, 1))
+  {
+    cout << " FAILED on bad arguments" << endl;
+    return false;
+  }
+  cout << " PASSED" << endl;
+  return true;
+} // TestPatch
+
+template<class CrcTraits>
+bool TestVerify() {
+  using namespace std;
+  using Crc = tjg::crc::Known<CrcTraits>;
+  cout << "Testing " << Crc::Name << " verify";
+  auto frame = std::array<std::byte, TestBuf.size() + Crc::TrailerSize>{};
+  std::ranges::copy(TestBuf, frame.begin());
+  std::ranges::copy(Crc::Trailer(Crc::Check), frame.begin() + TestBuf.size());
+  if (!Crc::Verify(frame)) {
+    cout << " FAILED" << endl;
+    return false;
+  }
+  for (auto& b: frame) {
+    b ^= std::byte{0x01};
+    auto ok = Crc::Verify(frame);
+    b ^= std::byte{0x01};
+    if (ok) {
+      cout << " FAILED to detect error" << endl;
+      return false;
+    }
+  }
+  cout << " PASSED" << endl;
+  return true;
+} // TestVerify
+
 int main() {
   int failCount = 0;
+  int testCount = 0;
 
   using Crcs = tjg::crc::test_detail::KnownCrcs;
 
   using namespace boost::mp11;
   mp_for_each<Crcs>([&](auto I) {
-    if (!Test<decltype(I)>())
-      ++failCount;
+    using CrcTraits = decltype(I);
+    for (auto test: {Test<CrcTraits>, TestCombine<CrcTraits>,
+                      TestZeros<CrcTraits>, TestShortSpans<CrcTraits>,
+                      TestPatch<CrcTraits>, TestVerify<CrcTraits>})
+    {
+      ++testCount;
+      if (!test())
+        ++failCount;
+    }
   });
 
-  std::cout << failCount << '/' << mp_size<Crcs>::value
+  std::cout << failCount << '/' << testCount
             << " tests failed." << std::endl;
   return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 } // main
@@ -1,4 +1,5 @@
 #include "crc/CrcKnown.hpp"
+#include "crc/CrcBuffered.hpp"
 
 #include "tjg/SaveIo.hpp"
 
@@ -67,6 +68,23 @@ auto RunCrcTestVariantBytes(std::span<const std::byte> data) {
   return TimedCrc{result, stop - start};
 } // RunCrcTestVariantBytes
 
+template<class CrcTraits>
+auto RunCrcTestVariantBuffered(std::span<const std::byte> data) {
+  std::cerr << " U" << std::flush;
+
+  using Crc = tjg::crc::BufferedCrc<CrcTraits>;
+  auto start = Clock::now();
+  Crc crc;
+  for (int i = 0; i != LoopCount; ++i) {
+    for (auto b: data)
+      crc(b);
+  }
+  auto result = crc.value();
+  auto stop = Clock::now();
+
+  return TimedCrc{result, stop - start};
+} // RunCrcTestVariantBuffered
+
 template<class CrcTraits, std::size_t SliceVal>
 auto RunCrcTestVariant(std::span<const std::byte> data) {
   std::cerr << ' ' << SliceVal << std::flush;
@@ -89,10 +107,11 @@ auto RunSlices(std::span<const std::byte> data) {
             << CrcTraits::Name << std::right << std::flush;
 
   std::vector<TimedCrc> results;
-  results.reserve(3 + sizeof...(SliceVals));
+  results.reserve(4 + sizeof...(SliceVals));
   results.emplace_back(RunCrcTestVariantBits<CrcTraits>(data));
   results.emplace_back(RunCrcTestVariantBytes<CrcTraits, 0>(data));
   results.emplace_back(RunCrcTestVariantBytes<CrcTraits, 1>(data));
+  results.emplace_back(RunCrcTestVariantBuffered<CrcTraits>(data));
 
   (results.emplace_back(RunCrcTestVariant<CrcTraits, SliceVals>(data)), ...);
 
@@ -0,0 +1,145 @@
+#include "tjg/Gf2Poly.hpp"
+#include "test/TestCheck.hpp"
+
+#include <random>
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+
+namespace IntMath = tjg::IntMath;
+using IntMath::Poly128;
+
+// Constant evaluation uses the portable code.
+static_assert(IntMath::ClMul(0, 0x1234) == Poly128{0});
+static_assert(IntMath::ClMul(3, 3) == Poly128{5});
+static_assert(IntMath::ClMul(0xffffffffffffffff, 0xffffffffffffffff)
+              == Poly128{0x5555555555555555, 0x5555555555555555});
+static_assert(IntMath::ClMul(0x8000000000000001, 0x8000000000000001)
+              == Poly128{0x0000000000000001, 0x4000000000000000});
+static_assert(IntMath::ClMul(0x123456789abcdef0, 0x0fedcba987654321)
+              == Poly128{0x40a0789828c810f0, 0x00e038d8688850b0});
+
+static_assert(IntMath::Mod(Poly128{0b1011'0110}, Poly128{0b1011})
+              == Poly128{0b110});
+static_assert(IntMath::Gcd(Poly128{0b110}, Poly128{0b11}) == Poly128{0b11});
+
+static_assert(IntMath::XPowMod(1000, 0x04c11db7, 32) == 0x267e9e6e);
+static_assert(IntMath::XPowMod(1000, 0x1021, 16) == 0x52cf);
+static_assert(IntMath::XPowMod(1000, 0x1b, 64) == 0xdb71c6000100000a);
+static_assert(IntMath::XPowMod(1000, 0x42f0e1eba9ea3693, 64)
+              == 0xb0cfaca967115e09);
+static_assert(IntMath::Gf2Modulus{0x04c11db7, 32}.mulMod(0x89abcdef, 0x87654321)
+              == 0x53b8a73);
+
+static_assert( IntMath::IsPrimitive(0x04c11db7, 32));   // CRC-32
+static_assert( IntMath::IsPrimitive(0x1b, 64));         // CRC-64/GO-ISO
+static_assert(!IntMath::IsIrreducible(0x1edc6f41, 32)); // CRC-32C
+static_assert(!IntMath::IsIrreducible(0x1021, 16));     // CRC-16/XMODEM
+static_assert( IntMath::IsIrreducible(0x3, 2));         // x^2+x+1
+static_assert(!IntMath::IsIrreducible(0x1, 2));         // (x+1)^2
+
+using namespace tjg::test;
+
+namespace {
+
+// Portable carry-less product, for comparison with the run-time path.
+Poly128 SlowClMul(std::uint64_t a, std::uint64_t b) {
+  auto p = Poly128{};
+  for (int i = 0; i != 64; ++i) {
+    if ((b >> i) & 1)
+      p ^= Poly128{a} << i;
+  }
+  return p;
+} // SlowClMul
+
+bool TestClMul(std::mt19937_64& rng) {
+  for (int i = 0; i != 100000; ++i) {
+    auto a = rng();
+    auto b = rng();
+    if (IntMath::ClMul(a, b) != SlowClMul(a, b))
+      return false;
+  }
+  return true;
+} // TestClMul
+
+// Barrett reduction against long division, for every width.
+bool TestMulMod(std::mt19937_64& rng) {
+  for (int bits = 1; bits <= 64; ++bits) {
+    auto mask = ~std::uint64_t{0} >> (64 - bits);
+    for (int i = 0; i != 1000; ++i) {
+      auto m = IntMath::Gf2Modulus{rng() | 1, bits};
+      auto a = rng() & mask;
+      auto b = rng() & mask;
+      auto expected = IntMath::Mod(SlowClMul(a, b), m.full());
+      if (m.mulMod(a, b) != expected.lo)
+        return false;
+    }
+  }
+  return true;
+} // TestMulMod
+
+// x^n mod P by repeated multiplication by x.
+bool TestPowX(std::mt19937_64& rng) {
+  for (int bits: {3, 8, 17, 32, 63, 64}) {
+    auto m = IntMath::Gf2Modulus{rng() | 1, bits};
+    auto r = IntMath::Mod(Poly128{1}, m.full());
+    for (std::uint64_t n = 0; n != 2000; ++n) {
+      if (m.powX(n) != r.lo)
+        return false;
+      r = IntMath::Mod(r << 1, m.full());
+    }
+  }
+  return true;
+} // TestPowX
+
+// The number of irreducible and primitive polynomials of each degree
+// (OEIS A001037 and A011260).
+bool TestCounts() {
+  constexpr int Irreducible[] = {0, 2, 1, 2, 3, 6, 9, 18, 30, 56, 99, 186,
+                                 335, 630, 1161, 2182, 4080, 7710};
+  constexpr int Primitive[]   = {0, 1, 1, 2, 2, 6, 6, 18, 16, 48, 60, 176,
+                                 144, 630, 756, 1800, 2048, 7710};
+  for (int bits = 1; bits != std::ssize(Irreducible); ++bits) {
+    auto irreducible = 0;
+    auto primitive = 0;
+    for (std::uint64_t poly = 0; poly >> bits == 0; ++poly) {
+      irreducible += IntMath::IsIrreducible(poly, bits);
+      primitive   += IntMath::IsPrimitive(poly, bits);
+    }
+    if (irreducible != Irreducible[bits] || primitive != Primitive[bits])
+      return false;
+  }
+  return true;
+} // TestCounts
+
+// The factor table: each factor divides 2^n - 1, and they account for all
+// of it.
+bool TestMersenneFactors() {
+  for (int n = 1; n <= 64; ++n) {
+    auto m = ~std::uint64_t{0} >> (64 - n);
+    for (auto f: IntMath::detail::MersenneFactors[n]) {
+      if (f == 0)
+        break;
+      if (m % f != 0)
+        return false;
+      while (m % f == 0)
+        m /= f;
+    }
+    if (m != 1)
+      return false;
+  }
+  return true;
+} // TestMersenneFactors
+
+} // anonymous
+
+int main() {
+  std::mt19937_64 rng{12345};
+  Check(TestClMul(rng), "ClMul");
+  Check(TestMulMod(rng), "Gf2Modulus::mulMod");
+  Check(TestPowX(rng), "Gf2Modulus::powX");
+  Check(TestCounts(), "IsIrreducible and IsPrimitive counts");
+  Check(TestMersenneFactors(), "MersenneFactors");
+
+  return Summary();
+} // main
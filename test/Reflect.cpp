@@ -1,5 +1,12 @@
 #include "tjg/Reflect.hpp"
+#include "test/TestCheck.hpp"
 
+#include <array>
+#include <vector>
+#include <span>
+#include <random>
+#include <iostream>
+#include <cstdlib>
 #include <cstddef>
 #include <cstdint>
 
@@ -43,4 +50,53 @@ static_assert(IntMath::Reflect(std::uint64_t{0x9dbeb90e4f225f0c}) == std::uint64
 static_assert(IntMath::Reflect(std::uint64_t{0xe51717a72902214a}) == std::uint64_t{0x52844094e5e8e8a7});
 static_assert(IntMath::Reflect(std::uint64_t{0x691f71cbcddb4574}) == std::uint64_t{0x2ea2dbb3d38ef896});
 
-int main() { return 0; }
+static_assert([] {
+    std::array<std::uint16_t, 3> a{0xa5ca, 0x0cba, 0x4079};
+    IntMath::Reflect(std::span{a});
+    return a == std::array<std::uint16_t, 3>{0x53a5, 0x5d30, 0x9e02};
+  }());
+
+static_assert([] {
+    std::array<std::byte, 2> a{std::byte{0xca}, std::byte{0x80}};
+    IntMath::Reflect(std::span{a});
+    return a == std::array<std::byte, 2>{std::byte{0x53}, std::byte{0x01}};
+  }());
+
+using namespace tjg::test;
+
+namespace {
+
+// Compares the bulk Reflect of spans of every length up to 100, at every
+// alignment, against the scalar Reflect.
+template<class T>
+bool TestSpan() {
+  auto rng = std::mt19937_64{};
+  auto src = std::vector<T>(108);
+  for (auto& x: src)
+    x = static_cast<T>(rng());
+  for (std::size_t offset = 0; offset != 8; ++offset) {
+    for (std::size_t n = 0; n <= 100; ++n) {
+      auto buf = src;
+      auto s = std::span{buf}.subspan(offset, n);
+      IntMath::Reflect(s);
+      for (std::size_t i = 0; i != src.size(); ++i) {
+        auto inside = (i >= offset && i < offset + n);
+        if (buf[i] != (inside ? IntMath::Reflect(src[i]) : src[i]))
+          return false;
+      }
+    }
+  }
+  return true;
+} // TestSpan
+
+} // anonymous
+
+int main() {
+  Check(TestSpan<std::byte>(),     "Reflect(span<byte>)");
+  Check(TestSpan<std::uint8_t>(),  "Reflect(span<uint8_t>)");
+  Check(TestSpan<std::uint16_t>(), "Reflect(span<uint16_t>)");
+  Check(TestSpan<std::uint32_t>(), "Reflect(span<uint32_t>)");
+  Check(TestSpan<std::uint64_t>(), "Reflect(span<uint64_t>)");
+
+  return Summary();
+} // main
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+namespace tjg::test {
+
+inline int failCount = 0;
+inline int testCount = 0;
+
+/// Counts a test and reports it as "Testing <what> PASSED" or "FAILED".
+inline void Check(bool passed, const char* what) {
+  ++testCount;
+  std::cout << "Testing " << what << (passed ? " PASSED" : " FAILED")
+            << std::endl;
+  failCount += !passed;
+} // Check
+
+/// Prints the tally and returns the exit status for main.
+inline int Summary() {
+  std::cout << failCount << '/' << testCount
+            << " tests failed." << std::endl;
+  return (failCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} // Summary
+
+/// Pseudo-random source for test data, seeded so that runs repeat.
+inline std::mt19937 Rng{12345};
+
+/// Writes `n` bytes from Rng at `offset` of `name`, creating the file or
+/// extending it as need be.
+inline void WriteRandom(const std::filesystem::path& name,
+                        std::uint64_t offset, std::size_t n)
+{
+  if (!std::filesystem::exists(name))
+    std::ofstream{name, std::ios::binary};
+  auto out = std::fstream{};
+  out.exceptions(std::ios::failbit | std::ios::badbit);
+  out.open(name, std::ios::in | std::ios::out | std::ios::binary);
+  out.seekp(static_cast<std::streamoff>(offset));
+  for (std::size_t i = 0; i != n; ++i)
+    out.put(static_cast<char>(Rng()));
+} // WriteRandom
+
+/// Dates the last modification of `name` `age` ago, so that it does not
+/// look as if it could still be changing.
+inline void Backdate(const std::filesystem::path& name,
+                     std::chrono::minutes age)
+{
+  namespace fs = std::filesystem;
+  fs::last_write_time(name, fs::file_time_type::clock::now() - age);
+} // Backdate
+
+} // tjg::test
@@ -0,0 +1,287 @@
+/// @file
+/// @copyright 2025 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+/// Polynomial arithmetic over GF(2): carry-less multiplication, reduction,
+/// x^n mod P, GCD, and irreducibility and primitivity tests.
+///
+/// A polynomial is held in an integer whose bit i is the coefficient of
+/// x^i.  Moduli have degree 1 to 64, so they are given CRC-style, as their
+/// degree and their coefficients below the leading term.  Products and
+/// dividends have up to 128 bits.  All functions are constexpr; at run time,
+/// carry-less products use PCLMULQDQ if the target supports it (e.g.,
+/// -mpclmul or -march=native).
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__PCLMUL__)
+#include <immintrin.h>
+#endif
+
+namespace tjg::IntMath {
+
+/// Polynomial over GF(2) of degree less than 128.
+struct Poly128 {
+  std::uint64_t lo = 0;   ///< Coefficients of x^0 to x^63.
+  std::uint64_t hi = 0;   ///< Coefficients of x^64 to x^127.
+
+  constexpr Poly128() noexcept = default;
+  constexpr Poly128(std::uint64_t lo_, std::uint64_t hi_ = 0) noexcept
+    : lo{lo_}, hi{hi_} { }
+
+  /// Degree, or -1 for the zero polynomial.
+  constexpr int degree() const noexcept {
+    return (hi != 0) ? 127 - std::countl_zero(hi)
+                     :  63 - std::countl_zero(lo);
+  }
+
+  constexpr bool coefficient(int i) const noexcept
+    { return ((i < 64) ? (lo >> i) : (hi >> (i - 64))) & 1; }
+
+  constexpr Poly128& operator^=(const Poly128& rhs) noexcept
+    { lo ^= rhs.lo; hi ^= rhs.hi; return *this; }
+
+  friend constexpr Poly128 operator^(Poly128 lhs, const Poly128& rhs) noexcept
+    { return lhs ^= rhs; }
+
+  /// Multiplication by x^n, modulo x^128.
+  friend constexpr Poly128 operator<<(const Poly128& p, int n) noexcept {
+    if (n == 0)
+      return p;
+    if (n >= 64)
+      return Poly128{0, (n >= 128) ? 0 : p.lo << (n - 64)};
+    return Poly128{p.lo << n, (p.hi << n) | (p.lo >> (64 - n))};
+  }
+
+  /// Division by x^n, discarding the remainder.
+  friend constexpr Poly128 operator>>(const Poly128& p, int n) noexcept {
+    if (n == 0)
+      return p;
+    if (n >= 64)
+      return Poly128{(n >= 128) ? 0 : p.hi >> (n - 64), 0};
+    return Poly128{(p.lo >> n) | (p.hi << (64 - n)), p.hi >> n};
+  }
+
+  /// `p` with each word masked by `mask`.
+  friend constexpr Poly128 operator&(const Poly128& p,
+                                     std::uint64_t mask) noexcept
+    { return Poly128{p.lo & mask, p.hi & mask}; }
+
+  friend constexpr bool operator==(const Poly128&, const Poly128&) = default;
+}; // Poly128
+
+/// Carry-less product of `a` and `b`.
+constexpr Poly128 ClMul(std::uint64_t a, std::uint64_t b) noexcept {
+#if defined(__PCLMUL__)
+  if !consteval {
+    auto va = _mm_cvtsi64_si128(static_cast<long long>(a));
+    auto vb = _mm_cvtsi64_si128(static_cast<long long>(b));
+    auto p = _mm_clmulepi64_si128(va, vb, 0x00);
+    return Poly128{static_cast<std::uint64_t>(_mm_cvtsi128_si64(p)),
+                   static_cast<std::uint64_t>(
+                     _mm_cvtsi128_si64(_mm_unpackhi_epi64(p, p)))};
+  }
+#endif
+  auto p = Poly128{};
+  for (int i = 0; i != 64; ++i) {
+    auto mask = 0 - ((b >> i) & 1);
+    p ^= Poly128{a << i, (i == 0) ? 0 : (a >> (64 - i))} & mask;
+  }
+  return p;
+} // ClMul
+
+/// Remainder of `a` divided by `m`, which must be nonzero.
+constexpr Poly128 Mod(Poly128 a, const Poly128& m) noexcept {
+  auto dm = m.degree();
+  for (auto da = a.degree(); da >= dm; da = a.degree())
+    a ^= m << (da - dm);
+  return a;
+} // Mod
+
+/// Quotient of `a` divided by `m`, which must be nonzero.
+constexpr Poly128 Div(Poly128 a, const Poly128& m) noexcept {
+  auto q = Poly128{};
+  auto dm = m.degree();
+  for (auto da = a.degree(); da >= dm; da = a.degree()) {
+    q ^= Poly128{1} << (da - dm);
+    a ^= m << (da - dm);
+  }
+  return q;
+} // Div
+
+/// Greatest common divisor of `a` and `b`.
+constexpr Poly128 Gcd(Poly128 a, Poly128 b) noexcept {
+  while (b.degree() >= 0) {
+    auto r = Mod(a, b);
+    a = b;
+    b = r;
+  }
+  return a;
+} // Gcd
+
+/// The modulus P(x) = x^bits + poly, for 1 <= bits <= 64, with Barrett
+/// reduction: a product costs three carry-less multiplications in all.
+class Gf2Modulus {
+private:
+  int _bits;
+  std::uint64_t _mask;  ///< Residues have `_bits` bits.
+  std::uint64_t _poly;  ///< P(x) - x^bits.
+  std::uint64_t _mu;    ///< floor(x^(2 bits) / P(x)) - x^bits.
+
+  /// floor(x^(2 bits) / P(x)) - x^bits, by long division; x^128 does not
+  /// fit in a Poly128.
+  constexpr std::uint64_t mu() const noexcept {
+    auto p = full();
+    auto r = Poly128{};
+    auto q = std::uint64_t{0};
+    for (int k = 2 * _bits; k >= 0; --k) {
+      r = (r << 1) ^ Poly128{(k == 2 * _bits) ? 1u : 0u};
+      if (r.degree() == _bits) {
+        r ^= p;
+        if (k < _bits)
+          q |= std::uint64_t{1} << k;
+      }
+    }
+    return q;
+  } // mu
+
+public:
+  constexpr Gf2Modulus(std::uint64_t poly, int bits) noexcept
+    : _bits{bits}
+    , _mask{~std::uint64_t{0} >> (64 - bits)}
+    , _poly{poly & _mask}
+    , _mu{mu()}
+  { }
+
+  constexpr int bits() const noexcept { return _bits; }
+  constexpr std::uint64_t poly() const noexcept { return _poly; }
+
+  /// P(x), including its leading term.
+  constexpr Poly128 full() const noexcept
+    { return Poly128{_poly} ^ (Poly128{1} << _bits); }
+
+  /// `a` mod P, for `a` of degree less than 2*bits.
+  constexpr std::uint64_t reduce(const Poly128& a) const noexcept {
+    // a = A1 x^n + A0; the quotient is A1 + floor(A1 mu' / x^n).
+    auto a1 = (a >> _bits).lo;
+    auto q = (ClMul(a1, _mu) >> _bits).lo ^ a1;
+    return (a.lo ^ ClMul(q, _poly).lo) & _mask;
+  } // reduce
+
+  /// a * b mod P, for residues `a` and `b`.
+  constexpr std::uint64_t mulMod(std::uint64_t a, std::uint64_t b)
+                                 const noexcept
+    { return reduce(ClMul(a, b)); }
+
+  /// x^n mod P.
+  constexpr std::uint64_t powX(std::uint64_t n) const noexcept {
+    auto result = reduce(Poly128{1});
+    auto base = reduce(Poly128{2});
+    for ( ; n != 0; n >>= 1) {
+      if (n & 1)
+        result = mulMod(result, base);
+      base = mulMod(base, base);
+    }
+    return result;
+  } // powX
+
+  /// x^(2^k) mod P, by k squarings.
+  constexpr std::uint64_t powX2k(int k) const noexcept {
+    auto r = reduce(Poly128{2});
+    while (k-- > 0)
+      r = mulMod(r, r);
+    return r;
+  } // powX2k
+}; // Gf2Modulus
+
+/// @internal
+namespace detail {
+
+/// Distinct prime factors of 2^n - 1, for n in [1, 64], zero-terminated.
+constexpr std::array<std::array<std::uint64_t, 12>, 65> MersenneFactors{{
+  {}, {}, {3}, {7}, {3, 5}, {31}, {3, 7}, {127}, {3, 5, 17}, {7, 73},
+  {3, 11, 31}, {23, 89}, {3, 5, 7, 13}, {8191}, {3, 43, 127}, {7, 31, 151},
+  {3, 5, 17, 257}, {131071}, {3, 7, 19, 73}, {524287}, {3, 5, 11, 31, 41},
+  {7, 127, 337}, {3, 23, 89, 683}, {47, 178481}, {3, 5, 7, 13, 17, 241},
+  {31, 601, 1801}, {3, 2731, 8191}, {7, 73, 262657},
+  {3, 5, 29, 43, 113, 127}, {233, 1103, 2089}, {3, 7, 11, 31, 151, 331},
+  {2147483647}, {3, 5, 17, 257, 65537}, {7, 23, 89, 599479},
+  {3, 43691, 131071}, {31, 71, 127, 122921},
+  {3, 5, 7, 13, 19, 37, 73, 109}, {223, 616318177}, {3, 174763, 524287},
+  {7, 79, 8191, 121369}, {3, 5, 11, 17, 31, 41, 61681},
+  {13367, 164511353}, {3, 7, 43, 127, 337, 5419}, {431, 9719, 2099863},
+  {3, 5, 23, 89, 397, 683, 2113}, {7, 31, 73, 151, 631, 23311},
+  {3, 47, 178481, 2796203}, {2351, 4513, 13264529},
+  {3, 5, 7, 13, 17, 97, 241, 257, 673}, {127, 4432676798593},
+  {3, 11, 31, 251, 601, 1801, 4051}, {7, 103, 2143, 11119, 131071},
+  {3, 5, 53, 157, 1613, 2731, 8191}, {6361, 69431, 20394401},
+  {3, 7, 19, 73, 87211, 262657}, {23, 31, 89, 881, 3191, 201961},
+  {3, 5, 17, 29, 43, 113, 127, 15790321}, {7, 32377, 524287, 1212847},
+  {3, 59, 233, 1103, 2089, 3033169}, {179951, 3203431780337},
+  {3, 5, 7, 11, 13, 31, 41, 61, 151, 331, 1321}, {2305843009213693951},
+  {3, 715827883, 2147483647}, {7, 73, 127, 337, 92737, 649657},
+  {3, 5, 17, 257, 641, 65537, 6700417}
+}}; // MersenneFactors
+
+/// Distinct prime factors of n <= 64, zero-terminated.
+constexpr std::array<int, 4> PrimeFactors(int n) noexcept {
+  auto factors = std::array<int, 4>{};
+  auto count = 0;
+  for (int p = 2; n > 1; ++p) {
+    if (n % p != 0)
+      continue;
+    factors[count++] = p;
+    while (n % p == 0)
+      n /= p;
+  }
+  return factors;
+} // PrimeFactors
+
+} // detail
+
+/// Is x^bits + poly irreducible?  Rabin's test: P of degree n is
+/// irreducible iff x^(2^n) = x mod P, and gcd(x^(2^(n/q)) - x, P) = 1 for
+/// each prime q dividing n.
+constexpr bool IsIrreducible(std::uint64_t poly, int bits) noexcept {
+  if ((poly & 1) == 0)
+    return bits == 1 && poly == 0;    // x itself.
+  auto m = Gf2Modulus{poly, bits};
+  auto x = m.powX(1);
+  if (m.powX2k(bits) != x)
+    return false;
+  for (auto q: detail::PrimeFactors(bits)) {
+    if (q == 0)
+      break;
+    auto r = m.powX2k(bits / q) ^ x;
+    if (Gcd(m.full(), Poly128{r}).degree() != 0)
+      return false;
+  }
+  return true;
+} // IsIrreducible
+
+/// Is x^bits + poly primitive, i.e., irreducible, with x of order
+/// 2^bits - 1?  Such a generator gives the longest period.
+constexpr bool IsPrimitive(std::uint64_t poly, int bits) noexcept {
+  if ((poly & 1) == 0 || !IsIrreducible(poly, bits))
+    return false;
+  auto m = Gf2Modulus{poly, bits};
+  auto order = ~std::uint64_t{0} >> (64 - bits);
+  for (auto r: detail::MersenneFactors[bits]) {
+    if (r == 0)
+      break;
+    if (m.powX(order / r) == 1)
+      return false;
+  }
+  return true;
+} // IsPrimitive
+
+/// x^n mod (x^bits + poly).
+constexpr std::uint64_t XPowMod(std::uint64_t n, std::uint64_t poly,
+                                int bits) noexcept
+  { return Gf2Modulus{poly, bits}.powX(n); }
+
+} // tjg::IntMath
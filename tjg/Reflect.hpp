@@ -5,9 +5,17 @@
 
 #pragma once
 
+#include <span>
+#include <algorithm>
+#include <concepts>
+#include <cstring>
 #include <cstdint>
 #include <cstddef>
 
+#if defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
 namespace tjg::IntMath {
 
 constexpr std::uint8_t Reflect(std::uint8_t x) noexcept {
@@ -47,4 +55,99 @@ constexpr std::uint64_t Reflect(std::uint64_t x) noexcept {
   return x;
 } // Reflect
 
+/// @internal
+namespace detail {
+
+#if defined(__SSSE3__)
+/// Reflects each byte of `v`: one GFNI affine transform, or two nibble
+/// table lookups with pshufb.
+inline __m128i ReflectBytes(__m128i v) noexcept {
+#if defined(__GFNI__)
+  return _mm_gf2p8affine_epi64_epi8(v, _mm_set1_epi64x(0x8040201008040201), 0);
+#else
+  const auto lo = _mm_setr_epi8(0x00, 0x08, 0x04, 0x0c, 0x02, 0x0a, 0x06, 0x0e,
+                                0x01, 0x09, 0x05, 0x0d, 0x03, 0x0b, 0x07, 0x0f);
+  const auto hi = _mm_slli_epi16(lo, 4);
+  const auto mask = _mm_set1_epi8(0x0f);
+  auto l = _mm_shuffle_epi8(hi, _mm_and_si128(v, mask));
+  auto h = _mm_shuffle_epi8(lo, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+  return _mm_or_si128(l, h);
+#endif
+} // ReflectBytes
+#endif
+
+/// Reflects each of the `size`-byte words, which are 1, 2, 4, or 8 bytes,
+/// in the `n` bytes at `p`.
+inline void ReflectWords(std::uint8_t* p, std::size_t n,
+                         std::size_t size) noexcept
+{
+#if defined(__SSSE3__)
+  // Byte order within each word is reversed by a shuffle.
+  const auto order =
+        (size == 1) ? _mm_setr_epi8( 0,  1,  2,  3,  4,  5,  6,  7,
+                                     8,  9, 10, 11, 12, 13, 14, 15)
+      : (size == 2) ? _mm_setr_epi8( 1,  0,  3,  2,  5,  4,  7,  6,
+                                     9,  8, 11, 10, 13, 12, 15, 14)
+      : (size == 4) ? _mm_setr_epi8( 3,  2,  1,  0,  7,  6,  5,  4,
+                                    11, 10,  9,  8, 15, 14, 13, 12)
+      :               _mm_setr_epi8( 7,  6,  5,  4,  3,  2,  1,  0,
+                                    15, 14, 13, 12, 11, 10,  9,  8);
+  for ( ; n >= 16; p += 16, n -= 16) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    if (size != 1)
+      v = _mm_shuffle_epi8(v, order);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), ReflectBytes(v));
+  }
+#endif
+  // Eight bytes at a time: reflect the bits of each byte, then swap the
+  // bytes, halves, and words that make up each `size`-byte word.
+  for ( ; n >= 8; p += 8, n -= 8) {
+    std::uint64_t x;
+    std::memcpy(&x, p, 8);
+    x = ((x & 0x5555555555555555) << 1) | ((x & 0xaaaaaaaaaaaaaaaa) >> 1);
+    x = ((x & 0x3333333333333333) << 2) | ((x & 0xcccccccccccccccc) >> 2);
+    x = ((x & 0x0f0f0f0f0f0f0f0f) << 4) | ((x & 0xf0f0f0f0f0f0f0f0) >> 4);
+    if (size >= 2)
+      x = ((x & 0x00ff00ff00ff00ff) << 8) | ((x & 0xff00ff00ff00ff00) >> 8);
+    if (size >= 4)
+      x = ((x & 0x0000ffff0000ffff) << 16) | ((x & 0xffff0000ffff0000) >> 16);
+    if (size >= 8)
+      x = (x << 32) | (x >> 32);
+    std::memcpy(p, &x, 8);
+  }
+  for ( ; n >= size; p += size, n -= size) {
+    std::reverse(p, p + size);
+    for (std::size_t i = 0; i != size; ++i)
+      p[i] = Reflect(p[i]);
+  }
+} // ReflectWords
+
+} // detail
+
+/// Reflects every element of `buf` in place.  At run time, whole buffers
+/// are processed 16 bytes at a time with GFNI or SSSE3 where available,
+/// and otherwise 8 bytes at a time.
+template<std::unsigned_integral T, std::size_t N>
+requires (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)
+constexpr void Reflect(std::span<T, N> buf) noexcept {
+  if consteval {
+    for (auto& x: buf)
+      x = Reflect(x);
+  } else {
+    detail::ReflectWords(reinterpret_cast<std::uint8_t*>(buf.data()),
+                         buf.size_bytes(), sizeof(T));
+  }
+} // Reflect
+
+template<std::size_t N>
+constexpr void Reflect(std::span<std::byte, N> buf) noexcept {
+  if consteval {
+    for (auto& x: buf)
+      x = Reflect(x);
+  } else {
+    detail::ReflectWords(reinterpret_cast<std::uint8_t*>(buf.data()),
+                         buf.size(), 1);
+  }
+} // Reflect
+
 } // tjg::IntMath